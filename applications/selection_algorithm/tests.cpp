@@ -11,23 +11,14 @@
 #include <vector>
 
 #include "selection_algorithm.hpp"
+#include "workload.hpp"
 
 namespace selection_algorithm::test {
 
 namespace bench {
 
-[[nodiscard]] auto generate_rand(int n) noexcept {
-  auto v = std::vector<int>(n);
-  std::iota(v.begin(), v.end(), 1);  // 1,2,...,size-1
-  std::shuffle(v.begin(), v.end(), std::mt19937(std::random_device()()));
-  return v;
-}
-
-[[nodiscard]] auto rand_int(int start, int stop) noexcept {
-  auto generator = std::mt19937(std::random_device()());
-  auto dist = std::uniform_int_distribution<int>(start, stop);
-  return dist(generator);
-}
+using soft_heap::workload::generate_rand;
+using soft_heap::workload::rand_int;
 
 }  // namespace bench
 
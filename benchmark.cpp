@@ -2,8 +2,43 @@
 
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <list>
+#include <malloc.h>
+#include <new>
+#include <thread>
+#include <utility>
 #include <vector>
 
+// Counts every heap allocation and its size for bench::AllocationCounter.
+// Kept out of line so GCC does not pair the inlined free with a
+// new-expression. Over-aligned allocations keep the library's own
+// operators and are not counted.
+[[gnu::noinline]] auto operator new(std::size_t size) -> void* {
+  if (auto* ptr = std::malloc(size)) {
+    soft_heap::bench::OnAllocate(
+        static_cast<std::int64_t>(malloc_usable_size(ptr)));
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* ptr) noexcept {
+  if (ptr != nullptr) {
+    soft_heap::bench::OnDeallocate(
+        static_cast<std::int64_t>(malloc_usable_size(ptr)));
+  }
+  std::free(ptr);
+}
+
+[[gnu::noinline]] void operator delete(void* ptr,
+                                      std::size_t /*size*/) noexcept {
+  operator delete(ptr);
+}
+
 namespace soft_heap {
 
 static auto sizes = std::vector<int64_t>{2 << 10, 2 << 12, 2 << 14};
@@ -60,6 +95,301 @@ using vector = std::vector<int>;
 // BENCHMARK(FlatSoftHeapExtract<vector, 1000>)->Apply(Args);
 BENCHMARK(SoftHeapExtract<vector, 1000>)->Apply(Args);
 
+// node allocation: make_unique per node vs. per-heap slab pool
+using pool = policy::PoolAllocation<>;
+BENCHMARK(SoftHeapConstruct<vector, 8>)->Apply(Args);
+BENCHMARK(SoftHeapConstruct<vector, 8, pool>)->Apply(Args);
+BENCHMARK(SoftHeapExtract<vector, 8>)->Apply(Args);
+BENCHMARK(SoftHeapExtract<vector, 8, pool>)->Apply(Args);
+
+// root list: std::list vs. rank-indexed array
+using linked = policy::LinkedRoots;
+using ranked = policy::RankedRoots;
+BENCHMARK(SoftHeapConstruct<vector, 8, policy::HeapAllocation, ranked>)
+    ->Apply(Args);
+BENCHMARK(SoftHeapExtract<vector, 8, policy::HeapAllocation, ranked>)
+    ->Apply(Args);
+BENCHMARK(FlatSoftHeapConstruct<vector, 8, linked>)->Apply(Args);
+BENCHMARK(FlatSoftHeapConstruct<vector, 8, ranked>)->Apply(Args);
+BENCHMARK(FlatSoftHeapExtract<vector, 8, linked>)->Apply(Args);
+BENCHMARK(FlatSoftHeapExtract<vector, 8, ranked>)->Apply(Args);
+
+// element lists: vector insert vs. O(1) splice
+using segmented = SegmentedList<int>;
+BENCHMARK(SoftHeapExtract<std::list<int>, 8>)->Apply(Args);
+BENCHMARK(SoftHeapExtract<segmented, 8>)->Apply(Args);
+BENCHMARK(FlatSoftHeapExtract<segmented, 8>)->Apply(Args);
+
+// construction: one carrying pass vs. Insert per element
+BENCHMARK(SoftHeapConstructByInsert<vector, 8>)->Apply(Args);
+BENCHMARK(SoftHeapConstructByInsert<vector, 8, pool>)->Apply(Args);
+BENCHMARK(FlatSoftHeapConstructByInsert<vector, 8>)->Apply(Args);
+
+// epsilon: template parameter vs. run-time dispatch to the same kernels
+BENCHMARK(SoftHeapExtract<vector, 2>)->Apply(Args);
+BENCHMARK(RuntimeSoftHeapExtract<vector>)
+    ->Unit(benchmark::kNanosecond)
+    ->ArgsProduct({sizes, {2, 8, 1000}})
+    ->Threads(1);
+
+// ExtractMin one by one vs. in batches of 1, 64 and 512
+static void BatchArgs(benchmark::internal::Benchmark* b) {
+  b->Unit(benchmark::kNanosecond)
+      ->ArgsProduct({sizes, {1, 64, 512}})
+      ->Threads(1);
+}
+BENCHMARK(SoftHeapExtractBatch<vector, 8>)->Apply(BatchArgs);
+BENCHMARK(FlatSoftHeapExtract<vector, 8>)->Apply(Args);
+BENCHMARK(FlatSoftHeapExtractBatch<vector, 8>)->Apply(BatchArgs);
+
+// bursts of 64 and 512 keys: Insert per key vs. InsertRange
+static void BurstArgs(benchmark::internal::Benchmark* b) {
+  b->Unit(benchmark::kNanosecond)
+      ->ArgsProduct({sizes, {64, 512}})
+      ->Threads(1);
+}
+BENCHMARK(SoftHeapInsertBursts<false, vector, 8>)->Apply(BurstArgs);
+BENCHMARK(SoftHeapInsertBursts<true, vector, 8>)->Apply(BurstArgs);
+BENCHMARK(FlatSoftHeapInsertBursts<false, vector, 8>)->Apply(BurstArgs);
+BENCHMARK(FlatSoftHeapInsertBursts<true, vector, 8>)->Apply(BurstArgs);
+
+// flat node storage: array of FlatNodes vs. split key/metadata/list arrays
+using split = policy::SplitArrayLayout;
+BENCHMARK(FlatSoftHeapConstruct<vector, 8, linked, split>)->Apply(Args);
+BENCHMARK(FlatSoftHeapExtract<vector, 8, linked, split>)->Apply(Args);
+BENCHMARK(FlatSoftHeapExtract<vector, 1000, linked>)->Apply(Args);
+BENCHMARK(FlatSoftHeapExtract<vector, 1000, linked, split>)->Apply(Args);
+
+// per-ExtractMin cost against heap size, expected O(log n)
+static void SteadyArgs(benchmark::internal::Benchmark* b) {
+  b->Unit(benchmark::kNanosecond)
+      ->RangeMultiplier(4)
+      ->Range(1 << 10, 1 << 20)
+      ->Complexity(benchmark::oLogN)
+      ->Threads(1);
+}
+BENCHMARK(SoftHeapExtractSteady<vector, 8>)->Apply(SteadyArgs);
+BENCHMARK(FlatSoftHeapExtractSteady<vector, 8>)->Apply(SteadyArgs);
+
+// Meld of two equal heaps: pointer links vs. flat block appends. The
+// untimed rebuild dominates each iteration, so the count is capped.
+static void MeldArgs(benchmark::internal::Benchmark* b) {
+  b->Unit(benchmark::kNanosecond)
+      ->ArgsProduct({sizes})
+      ->Iterations(200)
+      ->Threads(1);
+}
+BENCHMARK(SoftHeapMeld<vector, 8>)->Apply(MeldArgs);
+BENCHMARK(FlatSoftHeapMeld<vector, 8>)->Apply(MeldArgs);
+BENCHMARK(FlatSoftHeapMeld<vector, 8, linked, split>)->Apply(MeldArgs);
+
+// operation counts per key against inverse_epsilon, and the cost of
+// counting them against the NoStats baseline
+using counting = policy::CountingStats;
+BENCHMARK(SoftHeapOperationStats<policy::NoStats, 8>)->Apply(Args);
+BENCHMARK(SoftHeapOperationStats<counting, 8>)->Apply(Args);
+BENCHMARK(SoftHeapOperationStats<counting, 2>)->Apply(Args);
+BENCHMARK(SoftHeapOperationStats<counting, 1000>)->Apply(Args);
+
+// element lists: vector vs. inline buffer, see the allocs counters
+using inline_list = InlineList<int>;
+BENCHMARK(SoftHeapConstruct<inline_list, 8>)->Apply(Args);
+BENCHMARK(SoftHeapConstruct<inline_list, 8, pool>)->Apply(Args);
+BENCHMARK(SoftHeapExtract<inline_list, 8>)->Apply(Args);
+BENCHMARK(SoftHeapExtract<inline_list, 8, pool>)->Apply(Args);
+BENCHMARK(FlatSoftHeapConstruct<inline_list, 8>)->Apply(Args);
+BENCHMARK(FlatSoftHeapExtract<inline_list, 8>)->Apply(Args);
+
+// root-min tracking on ranked roots: suffix-min iterators vs. a SIMD scan of
+// the root keys, without peeks and with 4 Top() calls per ExtractMin
+using suffix_min = policy::SuffixMinRoots;
+using scan_min = policy::ScanMinRoots;
+static void RootMinArgs(benchmark::internal::Benchmark* b) {
+  b->Unit(benchmark::kNanosecond)
+      ->ArgsProduct({{1 << 10, 1 << 16, 1 << 20}, {0, 4}})
+      ->Threads(1);
+}
+BENCHMARK(SoftHeapRootMin<int, suffix_min>)->Apply(RootMinArgs);
+BENCHMARK(SoftHeapRootMin<int, scan_min>)->Apply(RootMinArgs);
+BENCHMARK(SoftHeapRootMin<int, suffix_min, 1000>)->Apply(RootMinArgs);
+BENCHMARK(SoftHeapRootMin<int, scan_min, 1000>)->Apply(RootMinArgs);
+BENCHMARK(SoftHeapRootMin<double, suffix_min>)->Apply(RootMinArgs);
+BENCHMARK(SoftHeapRootMin<double, scan_min>)->Apply(RootMinArgs);
+BENCHMARK(FlatSoftHeapRootMin<int, suffix_min>)->Apply(RootMinArgs);
+BENCHMARK(FlatSoftHeapRootMin<int, scan_min>)->Apply(RootMinArgs);
+
+// parallel bulk build of 1M and 16M keys, doubling from 1 thread up to every
+// hardware thread
+static void ParallelArgs(benchmark::internal::Benchmark* b) {
+  const auto max_threads =
+      std::max<int64_t>(1, std::thread::hardware_concurrency());
+  for (auto n : {int64_t{1} << 20, int64_t{1} << 24}) {
+    for (int64_t threads = 1; threads < max_threads; threads *= 2) {
+      b->Args({n, threads});
+    }
+    b->Args({n, max_threads});
+  }
+  b->Unit(benchmark::kMillisecond)->UseRealTime();
+}
+BENCHMARK(ParallelConstruct<SoftHeap<int>>)->Apply(ParallelArgs);
+BENCHMARK(ParallelConstruct<SoftHeap<int, InlineList<int>, 8,
+                                     policy::PoolAllocation<>>>)
+    ->Apply(ParallelArgs);
+BENCHMARK(ParallelConstruct<FlatSoftHeap<int>>)->Apply(ParallelArgs);
+
+// bulk build and half drain of every workload distribution at 64K and 1M
+// keys, with the peak share of corrupted keys; inputs come from the on-disk
+// workload cache after the first run
+static void DistributionArgs(benchmark::internal::Benchmark* b) {
+  for (auto n : {1 << 16, 1 << 20}) {
+    for (auto distribution : workload::distributions) {
+      b->Args({n, static_cast<int64_t>(distribution)});
+    }
+  }
+  b->Unit(benchmark::kMillisecond);
+}
+BENCHMARK(DistributionConstruct<SoftHeap<int>>)->Apply(DistributionArgs);
+BENCHMARK(DistributionConstruct<FlatSoftHeap<int>>)->Apply(DistributionArgs);
+
+// interleaved traffic on steady heaps, reported as ops/s: insert:extract
+// rounds of 1:1, 4:1, 1:4 and 16:1 from 1K to 1M keys, and the hold model
+// with each increment distribution from 1K to 1M keys. Holds of 10M and 100M
+// keys need several GB per heap and only run with
+// $SOFT_HEAP_BENCH_LARGE_HOLDS set.
+static void MixedArgs(benchmark::internal::Benchmark* b) {
+  for (auto n : {1 << 10, 1 << 14, 1 << 17, 1 << 20}) {
+    for (auto [inserts, extracts] : {std::pair{1, 1}, std::pair{4, 1},
+                                     std::pair{1, 4}, std::pair{16, 1}}) {
+      b->Args({n, inserts, extracts});
+    }
+  }
+  b->Unit(benchmark::kMillisecond);
+}
+
+static void HoldArgs(benchmark::internal::Benchmark* b) {
+  const int64_t max_n =
+      std::getenv("SOFT_HEAP_BENCH_LARGE_HOLDS") != nullptr ? 100'000'000
+                                                             : 1'000'000;
+  for (int64_t n = 1'000; n <= max_n; n *= 10) {
+    for (auto kind : {bench::Increment::kExponential,
+                      bench::Increment::kUniform,
+                      bench::Increment::kBimodal}) {
+      b->Args({n, static_cast<int64_t>(kind)});
+    }
+  }
+  b->Unit(benchmark::kNanosecond);
+}
+
+// the holds at one size over every element list and a range of epsilons
+static void HoldGridArgs(benchmark::internal::Benchmark* b) {
+  b->Args({1 << 20, static_cast<int64_t>(bench::Increment::kExponential)})
+      ->Unit(benchmark::kNanosecond);
+}
+
+template <class Element, class List = InlineList<Element>,
+          int inverse_epsilon = 8>
+using Soft = SoftHeap<Element, List, inverse_epsilon>;
+template <class Element, class List = InlineList<Element>,
+          int inverse_epsilon = 8>
+using Flat = FlatSoftHeap<Element, List, inverse_epsilon>;
+using Stl = bench::StlMinHeap<int>;
+
+BENCHMARK(MixedRatio<Soft<int>>)->Apply(MixedArgs);
+BENCHMARK(MixedRatio<Flat<int>>)->Apply(MixedArgs);
+BENCHMARK(MixedRatio<Stl>)->Apply(MixedArgs);
+BENCHMARK(Hold<Soft<double>>)->Apply(HoldArgs);
+BENCHMARK(Hold<Flat<double>>)->Apply(HoldArgs);
+BENCHMARK(Hold<bench::StlMinHeap<double>>)->Apply(HoldArgs);
+
+BENCHMARK(Hold<Soft<double, std::vector<double>>>)->Apply(HoldGridArgs);
+BENCHMARK(Hold<Soft<double, std::list<double>>>)->Apply(HoldGridArgs);
+BENCHMARK(Hold<Soft<double, SegmentedList<double>>>)->Apply(HoldGridArgs);
+BENCHMARK(Hold<Flat<double, std::vector<double>>>)->Apply(HoldGridArgs);
+BENCHMARK(Hold<Flat<double, std::list<double>>>)->Apply(HoldGridArgs);
+BENCHMARK(Hold<Flat<double, SegmentedList<double>>>)->Apply(HoldGridArgs);
+BENCHMARK(Hold<Soft<double, InlineList<double>, 2>>)->Apply(HoldGridArgs);
+BENCHMARK(Hold<Soft<double, InlineList<double>, 64>>)->Apply(HoldGridArgs);
+BENCHMARK(Hold<Soft<double, InlineList<double>, 1000>>)->Apply(HoldGridArgs);
+BENCHMARK(Hold<Flat<double, InlineList<double>, 2>>)->Apply(HoldGridArgs);
+BENCHMARK(Hold<Flat<double, InlineList<double>, 64>>)->Apply(HoldGridArgs);
+BENCHMARK(Hold<Flat<double, InlineList<double>, 1000>>)->Apply(HoldGridArgs);
+
+// memory per element of a bulk-built heap, after draining half of it and
+// after draining half or all of it and refilling, over every element list
+// and a range of epsilons; see the bytes/elem, peak_bytes, allocs and
+// deallocs counters
+static void FootprintArgs(benchmark::internal::Benchmark* b) {
+  b->ArgsProduct({{1 << 16, 1 << 20}, {0, 50}, {0}})
+      ->ArgsProduct({{1 << 16, 1 << 20}, {50, 100}, {1}})
+      ->Unit(benchmark::kMillisecond);
+}
+BENCHMARK(Footprint<Soft<int, std::vector<int>>>)->Apply(FootprintArgs);
+BENCHMARK(Footprint<Soft<int, std::list<int>>>)->Apply(FootprintArgs);
+BENCHMARK(Footprint<Soft<int, SegmentedList<int>>>)->Apply(FootprintArgs);
+BENCHMARK(Footprint<Soft<int>>)->Apply(FootprintArgs);
+BENCHMARK(Footprint<Soft<int, InlineList<int>, 2>>)->Apply(FootprintArgs);
+BENCHMARK(Footprint<Soft<int, InlineList<int>, 64>>)->Apply(FootprintArgs);
+BENCHMARK(Footprint<Soft<int, InlineList<int>, 1000>>)->Apply(FootprintArgs);
+BENCHMARK(Footprint<SoftHeap<int, InlineList<int>, 8, pool>>)
+    ->Apply(FootprintArgs);
+BENCHMARK(Footprint<Flat<int, std::vector<int>>>)->Apply(FootprintArgs);
+BENCHMARK(Footprint<Flat<int, std::list<int>>>)->Apply(FootprintArgs);
+BENCHMARK(Footprint<Flat<int, SegmentedList<int>>>)->Apply(FootprintArgs);
+BENCHMARK(Footprint<Flat<int>>)->Apply(FootprintArgs);
+BENCHMARK(Footprint<Flat<int, InlineList<int>, 2>>)->Apply(FootprintArgs);
+BENCHMARK(Footprint<Flat<int, InlineList<int>, 64>>)->Apply(FootprintArgs);
+BENCHMARK(Footprint<Flat<int, InlineList<int>, 1000>>)->Apply(FootprintArgs);
+
+// shared heap throughput: one mutex vs. two-choice sharding, 1 to 64 threads
+static void ConcurrentArgs(benchmark::internal::Benchmark* b) {
+  b->Unit(benchmark::kNanosecond)
+      ->Arg(1 << 16)
+      ->ThreadRange(1, 64)
+      ->UseRealTime();
+}
+using locked = bench::MutexSoftHeap<int>;
+using sharded = ConcurrentSoftHeap<int>;
+BENCHMARK(ConcurrentMixed<locked>)
+    ->Apply(ConcurrentArgs)
+    ->Setup(SetUpConcurrentMixed<locked>)
+    ->Teardown(TearDownConcurrentMixed<locked>);
+BENCHMARK(ConcurrentMixed<sharded>)
+    ->Apply(ConcurrentArgs)
+    ->Setup(SetUpConcurrentMixed<sharded>)
+    ->Teardown(TearDownConcurrentMixed<sharded>);
+
+// insert-only producers: mutex per key vs. buffers of 64 and 1024 keys
+// published by Meld. Iterations are capped to bound the heap's growth.
+static void ProducerArgs(benchmark::internal::Benchmark* b) {
+  b->Unit(benchmark::kNanosecond)
+      ->Iterations(1 << 14)
+      ->ThreadRange(1, 64)
+      ->UseRealTime();
+}
+BENCHMARK(MutexInsert)
+    ->Arg(1)
+    ->Apply(ProducerArgs)
+    ->Setup(SetUpMutexInsert)
+    ->Teardown(TearDownMutexInsert);
+BENCHMARK(BufferedInsert)
+    ->Arg(64)
+    ->Apply(ProducerArgs)
+    ->Setup(SetUpBufferedInsert)
+    ->Teardown(TearDownBufferedInsert);
+BENCHMARK(BufferedInsert)
+    ->Arg(1024)
+    ->Apply(ProducerArgs)
+    ->Setup(SetUpBufferedInsert)
+    ->Teardown(TearDownBufferedInsert);
+
+// rank error of the sharded heap against its shard count (2 per thread)
+BENCHMARK(ConcurrentSoftHeapRankError<8>)
+    ->Unit(benchmark::kMillisecond)
+    ->ArgsProduct({{1 << 16}, {1, 4, 16, 64}});
+BENCHMARK(ConcurrentSoftHeapRankError<1000>)
+    ->Unit(benchmark::kMillisecond)
+    ->ArgsProduct({{1 << 16}, {1, 4, 16, 64}});
+
 // BENCHMARK(FlatSoftHeapExtract)->Apply(Args);
 // BENCHMARK(SoftHeapExtract)->Apply(Args);
 // BENCHMARK(STLHeapExtract)->Apply(Args);
@@ -1,47 +1,234 @@
 #include <benchmark/benchmark.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <deque>
 #include <functional>
 #include <iostream>
 #include <list>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <queue>
 #include <random>
+#include <span>
 #include <string>
 #include <vector>
 
+#include "buffered_soft_heap.hpp"
+#include "concurrent_soft_heap.hpp"
 #include "flat_soft_heap.hpp"
+#include "inline_list.hpp"
 #include "node.hpp"
+#include "node_pool.hpp"
+#include "parallel_build.hpp"
+#include "ranked_trees.hpp"
+#include "runtime_epsilon.hpp"
+#include "segmented_list.hpp"
 #include "soft_heap.hpp"
+#include "stats.hpp"
 #include "tree.hpp"
+#include "workload.hpp"
 
 namespace soft_heap {
 
 namespace bench {
 
-[[nodiscard]] inline auto generate_rand(int n) noexcept {
-  auto v = std::vector<int>(n);
-  std::iota(v.begin(), v.end(), 1);  // 1,2,...,size-1
-  std::shuffle(v.begin(), v.end(), std::mt19937(std::random_device()()));
-  return v;
+using workload::generate_rand;
+using workload::rand_int;
+
+// Kept by the replacement global operator new and delete in benchmark.cpp.
+// Bytes are as malloc hands them out, rounding included.
+inline std::atomic<std::int64_t> allocations{0};
+inline std::atomic<std::int64_t> deallocations{0};
+inline std::atomic<std::int64_t> live_bytes{0};
+inline std::atomic<std::int64_t> peak_bytes{0};  // high-water of live_bytes
+
+inline void OnAllocate(std::int64_t bytes) noexcept {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  const auto live =
+      live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  auto peak = peak_bytes.load(std::memory_order_relaxed);
+  while (live > peak and not peak_bytes.compare_exchange_weak(
+                             peak, live, std::memory_order_relaxed)) {
+  }
 }
 
-[[nodiscard]] inline auto rand_int(int start, int stop) noexcept {
-  auto generator = std::mt19937(std::random_device()());
-  auto dist = std::uniform_int_distribution<int>(start, stop);
-  return dist(generator);
+inline void OnDeallocate(std::int64_t bytes) noexcept {
+  deallocations.fetch_add(1, std::memory_order_relaxed);
+  live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
 }
 
+// Heap traffic between Start and Stop, reported as user counters:
+//  - allocs, deallocs: per iteration, allocs/elem also per element of
+//    range(0)
+//  - peak_bytes: the most memory held above the level at Start, over all
+//    iterations
+//  - bytes/elem: memory still held at Stop per element of range(0), so the
+//    footprint of whatever was built in between and is still alive; zero
+//    when it was destroyed, negative when memory was released
+class AllocationCounter {
+ public:
+  void Start() noexcept {
+    start = allocations.load(std::memory_order_relaxed);
+    start_deallocs = deallocations.load(std::memory_order_relaxed);
+    start_bytes = live_bytes.load(std::memory_order_relaxed);
+    peak_bytes.store(start_bytes, std::memory_order_relaxed);
+  }
+
+  void Stop() noexcept {
+    total += allocations.load(std::memory_order_relaxed) - start;
+    total_deallocs +=
+        deallocations.load(std::memory_order_relaxed) - start_deallocs;
+    peak = std::max(peak,
+                    peak_bytes.load(std::memory_order_relaxed) - start_bytes);
+    held += live_bytes.load(std::memory_order_relaxed) - start_bytes;
+  }
+
+  void Report(benchmark::State& state) const {
+    const auto count = static_cast<double>(total);
+    const auto n = static_cast<double>(state.range(0));
+    state.counters["allocs"] =
+        benchmark::Counter(count, benchmark::Counter::kAvgIterations);
+    state.counters["allocs/elem"] =
+        benchmark::Counter(count / n, benchmark::Counter::kAvgIterations);
+    state.counters["deallocs"] = benchmark::Counter(
+        static_cast<double>(total_deallocs),
+        benchmark::Counter::kAvgIterations);
+    state.counters["peak_bytes"] = benchmark::Counter(
+        static_cast<double>(peak), benchmark::Counter::kDefaults,
+        benchmark::Counter::kIs1024);
+    state.counters["bytes/elem"] = benchmark::Counter(
+        static_cast<double>(held) / n, benchmark::Counter::kAvgIterations);
+  }
+
+ private:
+  std::int64_t start = 0;
+  std::int64_t start_deallocs = 0;
+  std::int64_t start_bytes = 0;
+  std::int64_t total = 0;
+  std::int64_t total_deallocs = 0;
+  std::int64_t peak = 0;
+  std::int64_t held = 0;
+};
+
+// SoftHeap behind a single mutex, the baseline for ConcurrentSoftHeap
+template <class Element, int inverse_epsilon = 8>
+class MutexSoftHeap {
+ public:
+  explicit MutexSoftHeap(std::size_t /*num_threads*/) noexcept {}
+
+  void Insert(Element e) noexcept {
+    const auto lock = std::lock_guard(mutex);
+    heap.Insert(std::move(e));
+  }
+
+  [[nodiscard]] auto ExtractMin() noexcept -> std::optional<Element> {
+    const auto lock = std::lock_guard(mutex);
+    if (heap.size() == 0) {
+      return std::nullopt;
+    }
+    return heap.ExtractMin();
+  }
+
+ private:
+  std::mutex mutex;
+  SoftHeap<Element, InlineList<Element>, inverse_epsilon> heap;
+};
+
+// std::priority_queue behind the soft heaps' interface, the exact baseline
+// for the mixed workloads
+template <class Element>
+class StlMinHeap {
+ public:
+  StlMinHeap(std::input_iterator auto first, std::input_iterator auto last)
+      : queue(first, last) {}
+
+  void Insert(Element e) { queue.push(std::move(e)); }
+
+  [[nodiscard]] auto ExtractMin() -> Element {
+    auto e = queue.top();
+    queue.pop();
+    return e;
+  }
+
+  [[nodiscard]] auto size() const noexcept { return queue.size(); }
+
+ private:
+  std::priority_queue<Element, std::vector<Element>, std::greater<>> queue;
+};
+
+// Hold-model increments with mean 1: exponential, uniform on [0, 2), or
+// bimodal (0.1 nine times in ten, else 9.1). Drawn up front and cycled so
+// the random number generator stays out of the timed loop.
+enum class Increment : std::int64_t { kExponential, kUniform, kBimodal };
+
+[[nodiscard]] inline auto HoldIncrements(Increment kind, std::size_t count,
+                                         unsigned seed) -> std::vector<double> {
+  auto gen = std::mt19937_64(seed);
+  auto exponential = std::exponential_distribution<double>(1.0);
+  auto uniform = std::uniform_real_distribution<double>(0.0, 2.0);
+  auto coin = std::bernoulli_distribution(0.1);
+  auto increments = std::vector<double>(count);
+  for (auto& x : increments) {
+    switch (kind) {
+      case Increment::kExponential:
+        x = exponential(gen);
+        break;
+      case Increment::kUniform:
+        x = uniform(gen);
+        break;
+      case Increment::kBimodal:
+        x = coin(gen) ? 9.1 : 0.1;
+        break;
+    }
+  }
+  return increments;
+}
+
+// Fenwick tree over the keys 1..n still in a heap, for the rank of each
+// extracted key among those left: 0 for an exact minimum
+class RankTracker {
+ public:
+  explicit RankTracker(int n) noexcept : tree(n + 1) {
+    for (int key = 1; key <= n; ++key) {
+      Add(key, 1);
+    }
+  }
+
+  // Removes key and returns how many smaller keys were still present
+  auto Remove(int key) noexcept -> int {
+    auto below = 0;
+    for (auto i = key - 1; i > 0; i -= i & -i) {
+      below += tree[i];
+    }
+    Add(key, -1);
+    return below;
+  }
+
+ private:
+  void Add(int key, int delta) noexcept {
+    for (auto i = key; i < std::ssize(tree); i += i & -i) {
+      tree[i] += delta;
+    }
+  }
+
+  std::vector<int> tree;
+};
+
 }  // namespace bench
 
-template <class List = std::vector<int>, int inverse_epsilon = 8>
+template <class List = std::vector<int>, int inverse_epsilon = 8,
+          class Roots = policy::LinkedRoots>
 static void FlatSoftHeapConstructManual(benchmark::State& state) {
   for (auto _ : state) {
     auto rand = bench::generate_rand(state.range(0));
     const auto start = std::chrono::high_resolution_clock::now();
-    benchmark::DoNotOptimize(
-        FlatSoftHeap<int, List, inverse_epsilon>(rand.begin(), rand.end()));
+    benchmark::DoNotOptimize(FlatSoftHeap<int, List, inverse_epsilon, Roots>(
+        rand.begin(), rand.end()));
     const auto end = std::chrono::high_resolution_clock::now();
     const auto elapsed_seconds =
         std::chrono::duration_cast<std::chrono::duration<double>>(end - start);
@@ -50,13 +237,16 @@ static void FlatSoftHeapConstructManual(benchmark::State& state) {
   }
 }
 
-template <class List = std::vector<int>, int inverse_epsilon = 8>
+template <class List = std::vector<int>, int inverse_epsilon = 8,
+          class Allocation = policy::HeapAllocation,
+          class Roots = policy::LinkedRoots>
 static void SoftHeapConstructManual(benchmark::State& state) {
   for (auto _ : state) {
     auto rand = bench::generate_rand(state.range(0));
     const auto start = std::chrono::high_resolution_clock::now();
     benchmark::DoNotOptimize(
-        SoftHeap<int, List, inverse_epsilon>(rand.begin(), rand.end()));
+        SoftHeap<int, List, inverse_epsilon, Allocation, Roots>(rand.begin(),
+                                                                rand.end()));
     const auto end = std::chrono::high_resolution_clock::now();
     const auto elapsed_seconds =
         std::chrono::duration_cast<std::chrono::duration<double>>(end - start);
@@ -80,32 +270,122 @@ static void SoftHeapConstructManual(benchmark::State& state) {
   }
 }
 
-template <class List = std::vector<int>, int inverse_epsilon = 8>
+template <class List = std::vector<int>, int inverse_epsilon = 8,
+          class Roots = policy::LinkedRoots,
+          class Layout = policy::NodeArrayLayout>
 static void FlatSoftHeapConstruct(benchmark::State& state) {
+  auto allocs = bench::AllocationCounter();
+  const auto rand =
+      workload::Cached(workload::Distribution::kUniform, state.range(0));
   for (auto _ : state) {
     state.PauseTiming();
-    auto rand = bench::generate_rand(state.range(0));
+    allocs.Start();
     state.ResumeTiming();
     benchmark::DoNotOptimize(
-        FlatSoftHeap<int, List, inverse_epsilon>(rand.begin(), rand.end()));
+        FlatSoftHeap<int, List, inverse_epsilon, Roots, policy::NaturalOrder,
+                     Layout>(rand.begin(), rand.end())
+            .size());
     benchmark::ClobberMemory();
+    allocs.Stop();
   }
+  allocs.Report(state);
   state.SetComplexityN(state.range(0));
 }
 
-template <class List = std::vector<int>, int inverse_epsilon = 8>
+template <class List = std::vector<int>, int inverse_epsilon = 8,
+          class Allocation = policy::HeapAllocation,
+          class Roots = policy::LinkedRoots>
 static void SoftHeapConstruct(benchmark::State& state) {
+  auto allocs = bench::AllocationCounter();
+  const auto rand =
+      workload::Cached(workload::Distribution::kUniform, state.range(0));
   for (auto _ : state) {
     state.PauseTiming();
-    auto rand = bench::generate_rand(state.range(0));
+    allocs.Start();
     state.ResumeTiming();
     benchmark::DoNotOptimize(
-        SoftHeap<int, List, inverse_epsilon>(rand.begin(), rand.end()));
+        SoftHeap<int, List, inverse_epsilon, Allocation, Roots>(rand.begin(),
+                                                                rand.end()));
+    benchmark::ClobberMemory();
+    allocs.Stop();
+  }
+  allocs.Report(state);
+  state.SetComplexityN(state.range(0));
+}
+
+// Baselines for the bulk range constructors: one Insert per element
+template <class List = std::vector<int>, int inverse_epsilon = 8,
+          class Roots = policy::LinkedRoots>
+static void FlatSoftHeapConstructByInsert(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto rand = bench::generate_rand(state.range(0));
+    state.ResumeTiming();
+    auto soft_heap =
+        FlatSoftHeap<int, List, inverse_epsilon, Roots>(std::move(rand[0]));
+    for (auto it = std::next(rand.begin()); it != rand.end(); ++it) {
+      soft_heap.Insert(std::move(*it));
+    }
+    benchmark::DoNotOptimize(soft_heap.size());
+    benchmark::ClobberMemory();
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+template <class List = std::vector<int>, int inverse_epsilon = 8,
+          class Allocation = policy::HeapAllocation,
+          class Roots = policy::LinkedRoots>
+static void SoftHeapConstructByInsert(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto rand = bench::generate_rand(state.range(0));
+    state.ResumeTiming();
+    auto soft_heap = SoftHeap<int, List, inverse_epsilon, Allocation, Roots>(
+        std::move(rand[0]));
+    for (auto it = std::next(rand.begin()); it != rand.end(); ++it) {
+      soft_heap.Insert(std::move(*it));
+    }
+    benchmark::DoNotOptimize(soft_heap.size());
     benchmark::ClobberMemory();
   }
   state.SetComplexityN(state.range(0));
 }
 
+// ParallelBuild of range(0) keys on range(1) threads; Heap is any SoftHeap
+// or FlatSoftHeap
+template <class Heap>
+static void ParallelConstruct(benchmark::State& state) {
+  const auto rand =
+      workload::Cached(workload::Distribution::kUniform, state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        ParallelBuild<Heap>(rand.begin(), rand.end(), state.range(1)).size());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Bulk-builds range(0) keys of the workload::Distribution range(1), then
+// extracts half of them, reporting the peak share of corrupted keys along
+// the way. Heap is any SoftHeap or FlatSoftHeap of int.
+template <class Heap>
+static void DistributionConstruct(benchmark::State& state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  const auto keys =
+      workload::Cached(static_cast<workload::Distribution>(state.range(1)), n);
+  auto peak = std::size_t{0};
+  for (auto _ : state) {
+    auto heap = Heap(keys.begin(), keys.end());
+    for (std::size_t i = 0; i < n / 2; ++i) {
+      benchmark::DoNotOptimize(heap.ExtractMin());
+      peak = std::max(peak, heap.num_corrupted_keys());
+    }
+  }
+  state.SetLabel(std::string(
+      workload::Name(static_cast<workload::Distribution>(state.range(1)))));
+  state.counters["corrupted"] = static_cast<double>(peak) / n;
+}
+
 [[maybe_unused]] static void STLHeapConstruct(benchmark::State& state) {
   for (auto _ : state) {
     state.PauseTiming();
@@ -119,12 +399,14 @@ static void SoftHeapConstruct(benchmark::State& state) {
   state.SetComplexityN(state.range(0));
 }
 
-template <class List = std::vector<int>, int inverse_epsilon = 8>
+template <class List = std::vector<int>, int inverse_epsilon = 8,
+          class Allocation = policy::HeapAllocation,
+          class Roots = policy::LinkedRoots>
 static void SoftHeapExtractManual(benchmark::State& state) {
   for (auto _ : state) {
     auto rand = bench::generate_rand(state.range(0));
-    auto soft_heap =
-        SoftHeap<int, List, inverse_epsilon>(rand.begin(), rand.end());
+    auto soft_heap = SoftHeap<int, List, inverse_epsilon, Allocation, Roots>(
+        rand.begin(), rand.end());
     const auto start = std::chrono::high_resolution_clock::now();
     for ([[maybe_unused]] auto&& x : rand) {
       benchmark::DoNotOptimize(soft_heap.ExtractMin());
@@ -137,12 +419,13 @@ static void SoftHeapExtractManual(benchmark::State& state) {
   }
 }
 
-template <class List = std::vector<int>, int inverse_epsilon = 8>
+template <class List = std::vector<int>, int inverse_epsilon = 8,
+          class Roots = policy::LinkedRoots>
 static void FlatSoftHeapExtractManual(benchmark::State& state) {
   for (auto _ : state) {
     auto rand = bench::generate_rand(state.range(0));
-    auto soft_heap =
-        FlatSoftHeap<int, List, inverse_epsilon>(rand.begin(), rand.end());
+    auto soft_heap = FlatSoftHeap<int, List, inverse_epsilon, Roots>(
+        rand.begin(), rand.end());
     const auto start = std::chrono::high_resolution_clock::now();
     for ([[maybe_unused]] auto&& x : rand) {
       benchmark::DoNotOptimize(soft_heap.ExtractMin());
@@ -174,13 +457,469 @@ static void FlatSoftHeapExtractManual(benchmark::State& state) {
   }
 }
 
-template <class List = std::vector<int>, int inverse_epsilon = 8>
+template <class List = std::vector<int>, int inverse_epsilon = 8,
+          class Allocation = policy::HeapAllocation,
+          class Roots = policy::LinkedRoots>
 static void SoftHeapExtract(benchmark::State& state) {
+  auto allocs = bench::AllocationCounter();
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto rand = bench::generate_rand(state.range(0));
+    auto soft_heap = SoftHeap<int, List, inverse_epsilon, Allocation, Roots>(
+        rand.begin(), rand.end());
+    allocs.Start();
+    state.ResumeTiming();
+    for ([[maybe_unused]] auto&& x : rand) {
+      benchmark::DoNotOptimize(soft_heap.ExtractMin());
+      benchmark::ClobberMemory();
+    }
+    allocs.Stop();
+  }
+  allocs.Report(state);
+}
+
+// Memory of a heap bulk-built from range(0) keys, measured while it is
+// alive, after extracting range(1) percent of them and, if range(2) is 1,
+// inserting as many keys again. Refilling shows what the drained trees keep;
+// bytes/elem should track the live keys, as sparse flat trees are compacted
+// (the FlatSoftHeap.CompactionBoundsSlotsBySize test asserts the slot
+// bound). Heap is any SoftHeap or FlatSoftHeap of int; the time is the
+// build, extractions and inserts alone.
+template <class Heap>
+static void Footprint(benchmark::State& state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  const auto extracts = n * static_cast<std::size_t>(state.range(1)) / 100;
+  const auto refill = state.range(2) != 0;
+  const auto keys = workload::Cached(workload::Distribution::kUniform, n);
+  auto memory = bench::AllocationCounter();
+  for (auto _ : state) {
+    memory.Start();
+    auto heap = std::optional<Heap>(std::in_place, keys.begin(), keys.end());
+    for (std::size_t i = 0; i < extracts; ++i) {
+      benchmark::DoNotOptimize(heap->ExtractMin());
+    }
+    for (std::size_t i = 0; refill and i < extracts; ++i) {
+      heap->Insert(keys[i]);
+    }
+    memory.Stop();
+    state.PauseTiming();
+    heap.reset();
+    state.ResumeTiming();
+  }
+  memory.Report(state);
+}
+
+// Build plus drain of range(0) keys under a Stats policy. Under
+// CountingStats the last run's counts are reported per key, for tuning
+// inverse_epsilon; under NoStats this times the uninstrumented baseline.
+template <class Stats, int inverse_epsilon = 8>
+static void SoftHeapOperationStats(benchmark::State& state) {
+  using Heap = SoftHeap<int, InlineList<int>, inverse_epsilon,
+                        policy::HeapAllocation, policy::LinkedRoots,
+                        policy::NaturalOrder, policy::AutoMinRoots, Stats>;
+  auto stats = StatsSnapshot();
   for (auto _ : state) {
     state.PauseTiming();
     auto rand = bench::generate_rand(state.range(0));
+    state.ResumeTiming();
+    auto soft_heap = Heap(rand.begin(), rand.end());
+    for ([[maybe_unused]] auto&& x : rand) {
+      benchmark::DoNotOptimize(soft_heap.ExtractMin());
+    }
+    stats = soft_heap.stats();
+  }
+  const auto per_key = [&](std::uint64_t count) {
+    return benchmark::Counter(static_cast<double>(count) /
+                              static_cast<double>(state.range(0)));
+  };
+  state.counters["combines/key"] = per_key(stats.combines);
+  state.counters["sifts/key"] = per_key(stats.sifts);
+  state.counters["moved/key"] = per_key(stats.elements_moved);
+  state.counters["leaf_deletions/key"] = per_key(stats.leaf_deletions);
+  state.counters["suffix_min/key"] = per_key(stats.suffix_min_updates);
+}
+
+// One ExtractMin per iteration on a heap held at state.range(0) elements:
+// each extracted key is re-inserted state.range(0) higher, so the cost per
+// ExtractMin can be fit against the heap size
+template <class List = std::vector<int>, int inverse_epsilon = 8,
+          class Roots = policy::LinkedRoots>
+static void FlatSoftHeapExtractSteady(benchmark::State& state) {
+  const auto n = static_cast<int>(state.range(0));
+  auto rand = bench::generate_rand(n);
+  auto soft_heap =
+      FlatSoftHeap<int, List, inverse_epsilon, Roots>(rand.begin(), rand.end());
+  for (auto _ : state) {
+    const auto x = soft_heap.ExtractMin();
+    benchmark::DoNotOptimize(x);
+    soft_heap.Insert(x + n);
+    benchmark::ClobberMemory();
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+template <class List = std::vector<int>, int inverse_epsilon = 8,
+          class Allocation = policy::HeapAllocation,
+          class Roots = policy::LinkedRoots>
+static void SoftHeapExtractSteady(benchmark::State& state) {
+  const auto n = static_cast<int>(state.range(0));
+  auto rand = bench::generate_rand(n);
+  auto soft_heap = SoftHeap<int, List, inverse_epsilon, Allocation, Roots>(
+      rand.begin(), rand.end());
+  for (auto _ : state) {
+    const auto x = soft_heap.ExtractMin();
+    benchmark::DoNotOptimize(x);
+    soft_heap.Insert(x + n);
+    benchmark::ClobberMemory();
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+// Interleaved traffic: a heap of range(0) keys takes rounds of range(1)
+// Inserts then range(2) ExtractMins, as many rounds as keep its size within
+// [0, 2 range(0)]; the heap is rebuilt between iterations, untimed. Heap is a
+// SoftHeap, FlatSoftHeap or bench::StlMinHeap of int.
+template <class Heap>
+static void MixedRatio(benchmark::State& state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  const auto inserts = static_cast<std::size_t>(state.range(1));
+  const auto extracts = static_cast<std::size_t>(state.range(2));
+  const auto rounds = std::max<std::size_t>(1, n / std::max(inserts, extracts));
+  const auto initial = bench::generate_rand(static_cast<int>(n));
+  const auto keys = bench::generate_rand(static_cast<int>(rounds * inserts));
+  auto ops = std::int64_t{0};
+  auto heap = std::optional<Heap>();
+  for (auto _ : state) {
+    state.PauseTiming();
+    heap.reset();  // the last run's heap is freed untimed too
+    heap.emplace(initial.begin(), initial.end());
+    state.ResumeTiming();
+    auto key = keys.begin();
+    for (std::size_t round = 0; round < rounds; ++round) {
+      for (std::size_t i = 0; i < inserts; ++i) {
+        heap->Insert(*key++);
+      }
+      for (std::size_t i = 0; i < extracts; ++i) {
+        benchmark::DoNotOptimize(heap->ExtractMin());
+      }
+    }
+    benchmark::ClobberMemory();
+    ops += static_cast<std::int64_t>(rounds * (inserts + extracts));
+  }
+  state.counters["ops/s"] =
+      benchmark::Counter(static_cast<double>(ops), benchmark::Counter::kIsRate);
+}
+
+// The classic hold model at a steady size of range(0): every iteration
+// extracts the minimum x and inserts x plus an increment drawn from
+// bench::Increment(range(1)). Heap holds doubles.
+template <class Heap>
+static void Hold(benchmark::State& state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  const auto kind = static_cast<bench::Increment>(state.range(1));
+  const auto initial = bench::HoldIncrements(kind, n, 1);
+  const auto increments = bench::HoldIncrements(kind, 1 << 16, 2);
+  auto heap = Heap(initial.begin(), initial.end());
+  auto next = std::size_t{0};
+  for (auto _ : state) {
+    const auto x = heap.ExtractMin();
+    heap.Insert(x + increments[next++ % increments.size()]);
+  }
+  benchmark::DoNotOptimize(heap.size());
+  state.counters["ops/s"] = benchmark::Counter(
+      2.0 * static_cast<double>(state.iterations()),
+      benchmark::Counter::kIsRate);
+}
+
+// Root-min tracking on rank-indexed roots, at a held size of range(0): each
+// iteration peeks Top() range(1) times, then extracts and re-inserts. Suffix
+// minima make Top O(1) but walk the roots whenever the min root is refilled;
+// the root-key scan is the other way around.
+template <class Key, class Tracking, int inverse_epsilon = 8>
+static void SoftHeapRootMin(benchmark::State& state) {
+  const auto n = static_cast<int>(state.range(0));
+  auto rand = bench::generate_rand(n);
+  auto soft_heap = SoftHeap<Key, InlineList<Key>, inverse_epsilon,
+                            policy::HeapAllocation, policy::RankedRoots,
+                            policy::NaturalOrder, Tracking>(rand.begin(),
+                                                            rand.end());
+  for (auto _ : state) {
+    for (auto peeks = state.range(1); peeks != 0; --peeks) {
+      benchmark::DoNotOptimize(soft_heap.Top());
+      benchmark::ClobberMemory();
+    }
+    const auto x = soft_heap.ExtractMin();
+    benchmark::DoNotOptimize(x);
+    soft_heap.Insert(x + n);
+    benchmark::ClobberMemory();
+  }
+}
+
+template <class Key, class Tracking, int inverse_epsilon = 8>
+static void FlatSoftHeapRootMin(benchmark::State& state) {
+  const auto n = static_cast<int>(state.range(0));
+  auto rand = bench::generate_rand(n);
+  auto soft_heap =
+      FlatSoftHeap<Key, InlineList<Key>, inverse_epsilon, policy::RankedRoots,
+                   policy::NaturalOrder, policy::NodeArrayLayout, Tracking>(
+          rand.begin(), rand.end());
+  for (auto _ : state) {
+    for (auto peeks = state.range(1); peeks != 0; --peeks) {
+      benchmark::DoNotOptimize(soft_heap.Top());
+      benchmark::ClobberMemory();
+    }
+    const auto x = soft_heap.ExtractMin();
+    benchmark::DoNotOptimize(x);
+    soft_heap.Insert(x + n);
+    benchmark::ClobberMemory();
+  }
+}
+
+// One heap shared by state.threads() threads, prefilled with range(0) keys;
+// every iteration inserts a random key and extracts one. The heap is built by
+// Setup before any thread starts and freed by Teardown after all finish.
+template <class Heap>
+inline auto concurrent_heap = std::unique_ptr<Heap>();
+
+template <class Heap>
+static void SetUpConcurrentMixed(const benchmark::State& state) {
+  concurrent_heap<Heap> = std::make_unique<Heap>(state.threads());
+  for (auto x : bench::generate_rand(state.range(0))) {
+    concurrent_heap<Heap>->Insert(x);
+  }
+}
+
+template <class Heap>
+static void TearDownConcurrentMixed(const benchmark::State& /*state*/) {
+  concurrent_heap<Heap>.reset();
+}
+
+template <class Heap>
+static void ConcurrentMixed(benchmark::State& state) {
+  auto& heap = *concurrent_heap<Heap>;
+  auto rng = std::minstd_rand(state.thread_index() + 1);
+  for (auto _ : state) {
+    heap.Insert(static_cast<int>(rng() % (1 << 30)));
+    benchmark::DoNotOptimize(heap.ExtractMin());
+  }
+  state.SetItemsProcessed(2 * state.iterations());
+}
+
+// Insert-only producers on one shared heap: a mutex-wrapped Insert per key
+// vs. per-thread buffers of range(0) keys published by Meld. The heap is
+// built by Setup before any thread starts and freed by Teardown after all
+// have finished, so producers flushing after the loop still find it.
+inline auto mutex_heap = std::unique_ptr<bench::MutexSoftHeap<int>>();
+inline auto buffered_heap = std::unique_ptr<BufferedSoftHeap<int>>();
+
+[[maybe_unused]] static void SetUpMutexInsert(const benchmark::State& state) {
+  mutex_heap = std::make_unique<bench::MutexSoftHeap<int>>(state.threads());
+}
+
+[[maybe_unused]] static void TearDownMutexInsert(
+    const benchmark::State& /*state*/) {
+  mutex_heap.reset();
+}
+
+[[maybe_unused]] static void SetUpBufferedInsert(
+    const benchmark::State& state) {
+  buffered_heap = std::make_unique<BufferedSoftHeap<int>>(state.range(0));
+}
+
+[[maybe_unused]] static void TearDownBufferedInsert(
+    const benchmark::State& /*state*/) {
+  buffered_heap.reset();
+}
+
+[[maybe_unused]] static void MutexInsert(benchmark::State& state) {
+  auto rng = std::minstd_rand(state.thread_index() + 1);
+  for (auto _ : state) {
+    mutex_heap->Insert(static_cast<int>(rng() % (1 << 30)));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+[[maybe_unused]] static void BufferedInsert(benchmark::State& state) {
+  auto rng = std::minstd_rand(state.thread_index() + 1);
+  // made on the first iteration, once every thread has passed the start
+  // barrier, and flushed when it goes out of scope after the loop
+  auto producer = std::optional<BufferedSoftHeap<int>::Producer>();
+  for (auto _ : state) {
+    if (not producer) [[unlikely]] {
+      producer.emplace(buffered_heap->MakeProducer());
+    }
+    producer->Insert(static_cast<int>(rng() % (1 << 30)));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Drains range(0) keys from a ConcurrentSoftHeap sized for range(1) threads
+// and reports how far each extracted key was from the true minimum
+template <int inverse_epsilon = 8>
+static void ConcurrentSoftHeapRankError(benchmark::State& state) {
+  const auto n = static_cast<int>(state.range(0));
+  auto total = 0.0;
+  auto worst = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto heap = ConcurrentSoftHeap<int, inverse_epsilon>(state.range(1));
+    for (auto x : bench::generate_rand(n)) {
+      heap.Insert(x);
+    }
+    auto ranks = bench::RankTracker(n);
+    state.ResumeTiming();
+    while (auto x = heap.ExtractMin()) {
+      const auto error = ranks.Remove(*x);
+      total += error;
+      worst = std::max(worst, error);
+    }
+  }
+  state.counters["rank_err_mean"] = benchmark::Counter(
+      total / n, benchmark::Counter::kAvgIterations);
+  state.counters["rank_err_max"] = worst;
+}
+
+// Melds two heaps of state.range(0) elements each; only Meld is timed
+template <class List = std::vector<int>, int inverse_epsilon = 8,
+          class Roots = policy::LinkedRoots,
+          class Layout = policy::NodeArrayLayout>
+static void FlatSoftHeapMeld(benchmark::State& state) {
+  using Heap = FlatSoftHeap<int, List, inverse_epsilon, Roots,
+                            policy::NaturalOrder, Layout>;
+  for (auto _ : state) {
+    state.PauseTiming();
+    {
+      auto rand = bench::generate_rand(2 * state.range(0));
+      const auto mid = std::next(rand.begin(), state.range(0));
+      auto soft_heap = Heap(rand.begin(), mid);
+      auto that = Heap(mid, rand.end());
+      state.ResumeTiming();
+      soft_heap.Meld(std::move(that));
+      benchmark::DoNotOptimize(soft_heap.size());
+      benchmark::ClobberMemory();
+      state.PauseTiming();  // not the teardown
+    }
+    state.ResumeTiming();
+  }
+}
+
+template <class List = std::vector<int>, int inverse_epsilon = 8,
+          class Allocation = policy::HeapAllocation,
+          class Roots = policy::LinkedRoots>
+static void SoftHeapMeld(benchmark::State& state) {
+  using Heap = SoftHeap<int, List, inverse_epsilon, Allocation, Roots>;
+  for (auto _ : state) {
+    state.PauseTiming();
+    {
+      auto rand = bench::generate_rand(2 * state.range(0));
+      const auto mid = std::next(rand.begin(), state.range(0));
+      auto soft_heap = Heap(rand.begin(), mid);
+      auto that = Heap(mid, rand.end());
+      state.ResumeTiming();
+      soft_heap.Meld(std::move(that));
+      benchmark::DoNotOptimize(soft_heap.size());
+      benchmark::ClobberMemory();
+      state.PauseTiming();  // not the teardown
+    }
+    state.ResumeTiming();
+  }
+}
+
+// Drains the heap state.range(1) elements at a time
+template <class List = std::vector<int>, int inverse_epsilon = 8,
+          class Allocation = policy::HeapAllocation,
+          class Roots = policy::LinkedRoots>
+static void SoftHeapExtractBatch(benchmark::State& state) {
+  auto out = std::vector<int>(state.range(1));
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto rand = bench::generate_rand(state.range(0));
+    auto soft_heap = SoftHeap<int, List, inverse_epsilon, Allocation, Roots>(
+        rand.begin(), rand.end());
+    state.ResumeTiming();
+    while (soft_heap.size() != 0) {
+      benchmark::DoNotOptimize(soft_heap.ExtractMinBatch(std::span(out)));
+      benchmark::ClobberMemory();
+    }
+  }
+}
+
+template <class List = std::vector<int>, int inverse_epsilon = 8,
+          class Roots = policy::LinkedRoots>
+static void FlatSoftHeapExtractBatch(benchmark::State& state) {
+  auto out = std::vector<int>(state.range(1));
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto rand = bench::generate_rand(state.range(0));
+    auto soft_heap = FlatSoftHeap<int, List, inverse_epsilon, Roots>(
+        rand.begin(), rand.end());
+    state.ResumeTiming();
+    while (soft_heap.size() != 0) {
+      benchmark::DoNotOptimize(soft_heap.ExtractMinBatch(std::span(out)));
+      benchmark::ClobberMemory();
+    }
+  }
+}
+
+// Grows a heap of state.range(0) keys by as many more, arriving in bursts of
+// state.range(1), either through InsertRange or through Insert per key
+template <bool insert_range, class List = std::vector<int>,
+          int inverse_epsilon = 8, class Allocation = policy::HeapAllocation,
+          class Roots = policy::LinkedRoots>
+static void SoftHeapInsertBursts(benchmark::State& state) {
+  const auto burst = state.range(1);
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto rand = bench::generate_rand(2 * state.range(0));
+    auto mid = std::next(rand.begin(), state.range(0));
+    auto soft_heap = SoftHeap<int, List, inverse_epsilon, Allocation, Roots>(
+        rand.begin(), mid);
+    state.ResumeTiming();
+    for (auto first = mid; first != rand.end(); std::advance(first, burst)) {
+      if constexpr (insert_range) {
+        soft_heap.InsertRange(first, std::next(first, burst));
+      } else {
+        std::for_each(first, std::next(first, burst),
+                      [&](int x) { soft_heap.Insert(x); });
+      }
+    }
+    benchmark::DoNotOptimize(soft_heap.size());
+    benchmark::ClobberMemory();
+  }
+}
+
+template <bool insert_range, class List = std::vector<int>,
+          int inverse_epsilon = 8, class Roots = policy::LinkedRoots>
+static void FlatSoftHeapInsertBursts(benchmark::State& state) {
+  const auto burst = state.range(1);
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto rand = bench::generate_rand(2 * state.range(0));
+    auto mid = std::next(rand.begin(), state.range(0));
     auto soft_heap =
-        SoftHeap<int, List, inverse_epsilon>(rand.begin(), rand.end());
+        FlatSoftHeap<int, List, inverse_epsilon, Roots>(rand.begin(), mid);
+    state.ResumeTiming();
+    for (auto first = mid; first != rand.end(); std::advance(first, burst)) {
+      if constexpr (insert_range) {
+        soft_heap.InsertRange(first, std::next(first, burst));
+      } else {
+        std::for_each(first, std::next(first, burst),
+                      [&](int x) { soft_heap.Insert(x); });
+      }
+    }
+    benchmark::DoNotOptimize(soft_heap.size());
+    benchmark::ClobberMemory();
+  }
+}
+
+// Epsilon chosen at run time as 1 / state.range(1)
+template <class List = std::vector<int>>
+static void RuntimeSoftHeapExtract(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto rand = bench::generate_rand(state.range(0));
+    auto soft_heap = RuntimeSoftHeap<int, List>(
+        1.0 / static_cast<double>(state.range(1)), rand.begin(), rand.end());
     state.ResumeTiming();
     for ([[maybe_unused]] auto&& x : rand) {
       benchmark::DoNotOptimize(soft_heap.ExtractMin());
@@ -189,19 +928,26 @@ static void SoftHeapExtract(benchmark::State& state) {
   }
 }
 
-template <class List = std::vector<int>, int inverse_epsilon = 8>
+template <class List = std::vector<int>, int inverse_epsilon = 8,
+          class Roots = policy::LinkedRoots,
+          class Layout = policy::NodeArrayLayout>
 static void FlatSoftHeapExtract(benchmark::State& state) {
+  auto allocs = bench::AllocationCounter();
   for (auto _ : state) {
     state.PauseTiming();
     auto rand = bench::generate_rand(state.range(0));
-    auto soft_heap =
-        FlatSoftHeap<int, List, inverse_epsilon>(rand.begin(), rand.end());
+    auto soft_heap = FlatSoftHeap<int, List, inverse_epsilon, Roots,
+                                  policy::NaturalOrder, Layout>(rand.begin(),
+                                                                rand.end());
+    allocs.Start();
     state.ResumeTiming();
     for ([[maybe_unused]] auto&& x : rand) {
       benchmark::DoNotOptimize(soft_heap.ExtractMin());
       benchmark::ClobberMemory();
     }
+    allocs.Stop();
   }
+  allocs.Report(state);
 }
 
 [[maybe_unused]] static void STLHeapExtract(benchmark::State& state) {
@@ -219,26 +965,29 @@ static void FlatSoftHeapExtract(benchmark::State& state) {
   }
 }
 
-template <class List = std::vector<int>, int inverse_epsilon = 8>
+template <class List = std::vector<int>, int inverse_epsilon = 8,
+          class Allocation = policy::HeapAllocation,
+          class Roots = policy::LinkedRoots>
 static void SoftHeapExtractOne(benchmark::State& state) {
   for (auto _ : state) {
     state.PauseTiming();
     auto rand = bench::generate_rand(state.range(0));
-    auto soft_heap =
-        SoftHeap<int, List, inverse_epsilon>(rand.begin(), rand.end());
+    auto soft_heap = SoftHeap<int, List, inverse_epsilon, Allocation, Roots>(
+        rand.begin(), rand.end());
     state.ResumeTiming();
     benchmark::DoNotOptimize(soft_heap.ExtractMin());
     benchmark::ClobberMemory();
   }
 }
 
-template <class List = std::vector<int>, int inverse_epsilon = 8>
+template <class List = std::vector<int>, int inverse_epsilon = 8,
+          class Roots = policy::LinkedRoots>
 static void FlatSoftHeapExtractOne(benchmark::State& state) {
   for (auto _ : state) {
     state.PauseTiming();
     auto rand = bench::generate_rand(state.range(0));
-    auto soft_heap =
-        FlatSoftHeap<int, List, inverse_epsilon>(rand.begin(), rand.end());
+    auto soft_heap = FlatSoftHeap<int, List, inverse_epsilon, Roots>(
+        rand.begin(), rand.end());
     state.ResumeTiming();
     benchmark::DoNotOptimize(soft_heap.ExtractMin());
     benchmark::ClobberMemory();
@@ -52,4 +52,22 @@ concept TotalOrderedContainer =
 static_assert(TotalOrderedContainer<std::vector<int>>);
 static_assert(TotalOrderedContainer<std::string>);
 
+template <class ContainerType>
+concept SpliceableContainer = requires(ContainerType a, ContainerType b) {
+  requires TotalOrderedContainer<ContainerType>;
+  a.splice(a.end(), b);
+};
+
+template <class Allocation>
+concept NodeAllocation = requires {
+  typename Allocation::template Deleter<int>;
+  typename Allocation::template Resource<int>;
+};
+
+template <class Roots>
+concept RootContainer = requires {
+  typename Roots::template Container<int>;
+  { Roots::rank_indexed } -> std::convertible_to<bool>;
+};
+
 }  // namespace soft_heap::policy
\ No newline at end of file
@@ -1,4 +1,11 @@
 #pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+#include "policies.hpp"
 
 namespace soft_heap {
 
@@ -7,4 +14,38 @@ namespace soft_heap {
   return in > out ? out + 1 : out;
 }
 
+// Rank r = ceil(log2(1/epsilon)) + 5 above which node sizes start growing
+[[nodiscard]] constexpr auto RankThreshold(double inverse_epsilon) noexcept
+    -> int {
+  return ConstCeil(std::log2(inverse_epsilon)) + 5;
+}
+
+// Appends the elements of `from` to `into`. Lists with splice are relinked
+// in O(1) and left empty; anything else is moved over element by element.
+template <policy::TotalOrderedContainer List>
+constexpr void Concat(List& into, List& from) noexcept {
+  if constexpr (policy::SpliceableContainer<List>) {
+    into.splice(into.end(), from);
+  } else if (into.empty()) {
+    into = std::move(from);
+  } else {
+    into.insert(into.end(), std::make_move_iterator(from.begin()),
+                std::make_move_iterator(from.end()));
+  }
+}
+
+// Drops the elements pred accepts and keeps the rest in order. Only
+// pop_back is needed to shrink, so every list here can be pruned in place.
+// Returns how many were dropped.
+template <policy::TotalOrderedContainer List>
+constexpr auto EraseIf(List& list, auto&& pred) noexcept -> std::size_t {
+  const auto kept = std::remove_if(list.begin(), list.end(), pred);
+  const auto erased =
+      static_cast<std::size_t>(std::distance(kept, list.end()));
+  for (auto n = erased; n != 0; --n) {
+    list.pop_back();
+  }
+  return erased;
+}
+
 }  // namespace soft_heap
\ No newline at end of file
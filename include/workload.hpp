@@ -0,0 +1,261 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+// Seeded input generators shared by the tests and benchmarks. The same
+// distribution, size and seed give the same keys on every run and platform:
+// only std::mt19937_64 is used, never a std:: distribution, whose output is
+// implementation-defined.
+namespace soft_heap::workload {
+
+inline constexpr std::uint64_t default_seed = 0x50F7'4EA9;
+
+enum class Distribution : std::int64_t {
+  kUniform,       // 1..n shuffled
+  kSorted,        // 1..n
+  kReverse,       // n..1
+  kNearlySorted,  // 1..n with n/100 short-range swaps
+  kDuplicates,    // n keys drawn from only 16 values
+  kZipf,          // key k with probability about 1/k, from 1..n
+  kSawtooth,      // distinct keys in sqrt(n) ascending runs
+  kAdversarial,   // 1..n in bit-reversed order, see Adversarial below
+};
+
+inline constexpr auto distributions = std::array{
+    Distribution::kUniform,      Distribution::kSorted,
+    Distribution::kReverse,      Distribution::kNearlySorted,
+    Distribution::kDuplicates,   Distribution::kZipf,
+    Distribution::kSawtooth,     Distribution::kAdversarial};
+
+[[nodiscard]] constexpr auto Name(Distribution distribution) noexcept
+    -> std::string_view {
+  switch (distribution) {
+    case Distribution::kUniform:
+      return "uniform";
+    case Distribution::kSorted:
+      return "sorted";
+    case Distribution::kReverse:
+      return "reverse";
+    case Distribution::kNearlySorted:
+      return "nearly_sorted";
+    case Distribution::kDuplicates:
+      return "duplicates";
+    case Distribution::kZipf:
+      return "zipf";
+    case Distribution::kSawtooth:
+      return "sawtooth";
+    case Distribution::kAdversarial:
+      return "adversarial";
+  }
+  return "unknown";
+}
+
+namespace detail {
+
+// Uniform in [0, bound); the modulo bias is below bound / 2^64
+[[nodiscard]] inline auto Below(std::mt19937_64& gen,
+                                std::uint64_t bound) noexcept
+    -> std::uint64_t {
+  return gen() % bound;
+}
+
+// Uniform in [0, 1) from the top 53 bits
+[[nodiscard]] inline auto Unit(std::mt19937_64& gen) noexcept -> double {
+  return static_cast<double>(gen() >> 11) * 0x1.0p-53;
+}
+
+// Fisher-Yates with Below, as std::shuffle is implementation-defined too
+inline void Shuffle(std::vector<int>& v, std::mt19937_64& gen) noexcept {
+  for (auto i = v.size(); i > 1; --i) {
+    std::swap(v[i - 1], v[Below(gen, i)]);
+  }
+}
+
+[[nodiscard]] inline auto Iota(std::size_t n) noexcept -> std::vector<int> {
+  auto v = std::vector<int>(n);
+  std::iota(v.begin(), v.end(), 1);
+  return v;
+}
+
+[[nodiscard]] inline auto NearlySorted(std::size_t n,
+                                       std::mt19937_64& gen) noexcept {
+  auto v = Iota(n);
+  for (std::size_t k = 0; n > 1 and k < n / 100; ++k) {
+    const auto i = Below(gen, n - 1);
+    const auto j = std::min(n - 1, i + 1 + Below(gen, 16));
+    std::swap(v[i], v[j]);
+  }
+  return v;
+}
+
+// Zipf with exponent 1 through the inverse of its continuous approximation:
+// floor((n + 1)^u) has P(k) = log((k + 1) / k) / log(n + 1), which tends to
+// the 1/(k H_n) of the discrete law as k grows
+[[nodiscard]] inline auto Zipf(std::size_t n, std::mt19937_64& gen) noexcept {
+  auto v = std::vector<int>(n);
+  const auto log_range = std::log(static_cast<double>(n) + 1);
+  for (auto& x : v) {
+    const auto k = static_cast<std::size_t>(std::exp(Unit(gen) * log_range));
+    x = static_cast<int>(std::clamp<std::size_t>(k, 1, n));
+  }
+  return v;
+}
+
+// Runs of about sqrt(n) ascending keys; run r holds r + 1, r + 1 + runs, ...
+// so every key is distinct and each run restarts below the last one's end
+[[nodiscard]] inline auto Sawtooth(std::size_t n) noexcept {
+  const auto root = std::ceil(std::sqrt(static_cast<double>(n)));
+  const auto length = std::max<std::size_t>(1, static_cast<std::size_t>(root));
+  const auto runs = (n + length - 1) / length;
+  auto v = std::vector<int>(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    v[i] = static_cast<int>((i % length) * runs + i / length + 1);
+  }
+  return v;
+}
+
+// 1..n ordered by the bit reversal of their index, so every pair of trees a
+// link joins holds keys interleaved across the whole range. No insertion
+// order does much worse to a soft heap than a shuffle, as its corruption is
+// set mostly by the shapes of its trees: this one matched the worst a local
+// search over swaps found, about 13 times the peak corruption of sorted
+// input, without depending on a seed.
+[[nodiscard]] inline auto Adversarial(std::size_t n) noexcept {
+  const auto bits = std::countr_zero(std::bit_ceil(n));
+  auto v = std::vector<int>();
+  v.reserve(n);
+  for (std::size_t i = 0; v.size() < n; ++i) {
+    auto reversed = std::size_t{0};
+    for (int b = 0; b < bits; ++b) {
+      reversed |= ((i >> b) & 1) << (bits - 1 - b);
+    }
+    if (reversed < n) {
+      v.push_back(static_cast<int>(reversed + 1));
+    }
+  }
+  return v;
+}
+
+}  // namespace detail
+
+// n keys of the given distribution. Only kUniform, kNearlySorted,
+// kDuplicates and kZipf depend on the seed.
+[[nodiscard]] inline auto Generate(Distribution distribution, std::size_t n,
+                                   std::uint64_t seed = default_seed) noexcept
+    -> std::vector<int> {
+  auto gen = std::mt19937_64(seed);
+  switch (distribution) {
+    case Distribution::kUniform: {
+      auto v = detail::Iota(n);
+      detail::Shuffle(v, gen);
+      return v;
+    }
+    case Distribution::kSorted:
+      return detail::Iota(n);
+    case Distribution::kReverse: {
+      auto v = detail::Iota(n);
+      std::reverse(v.begin(), v.end());
+      return v;
+    }
+    case Distribution::kNearlySorted:
+      return detail::NearlySorted(n, gen);
+    case Distribution::kDuplicates: {
+      auto v = std::vector<int>(n);
+      for (auto& x : v) {
+        x = static_cast<int>(detail::Below(gen, 16)) + 1;
+      }
+      return v;
+    }
+    case Distribution::kZipf:
+      return detail::Zipf(n, gen);
+    case Distribution::kSawtooth:
+      return detail::Sawtooth(n);
+    case Distribution::kAdversarial:
+      return detail::Adversarial(n);
+  }
+  return {};
+}
+
+// The shuffled 1..n every test and benchmark builds its heaps from
+[[nodiscard]] inline auto generate_rand(
+    int n, std::uint64_t seed = default_seed) noexcept -> std::vector<int> {
+  return Generate(Distribution::kUniform, static_cast<std::size_t>(n), seed);
+}
+
+// A uniform key in [start, stop] drawn from gen
+[[nodiscard]] inline auto rand_int(int start, int stop,
+                                   std::mt19937_64& gen) noexcept -> int {
+  const auto range = static_cast<std::uint64_t>(
+      static_cast<std::int64_t>(stop) - static_cast<std::int64_t>(start) + 1);
+  return static_cast<int>(start + static_cast<std::int64_t>(
+                                      detail::Below(gen, range)));
+}
+
+// The same from a per-thread generator seeded with default_seed, so every
+// run repeats its sequence of keys; pass a generator for any other seed
+[[nodiscard]] inline auto rand_int(int start, int stop) noexcept -> int {
+  thread_local auto gen = std::mt19937_64(default_seed);
+  return rand_int(start, stop, gen);
+}
+
+// Where Cached keeps its files: $SOFT_HEAP_WORKLOAD_CACHE if set, otherwise
+// soft_heap_workloads under the system temporary directory
+[[nodiscard]] inline auto CacheDirectory() noexcept -> std::filesystem::path {
+  if (const auto* dir = std::getenv("SOFT_HEAP_WORKLOAD_CACHE")) {
+    return dir;
+  }
+  auto error = std::error_code();
+  return std::filesystem::temp_directory_path(error) / "soft_heap_workloads";
+}
+
+// Generate, backed by a file per (distribution, n, seed) under dir, so large
+// benchmarks read their inputs back instead of regenerating them. A missing,
+// short or unwritable cache only costs the generation.
+[[nodiscard]] inline auto Cached(Distribution distribution, std::size_t n,
+                                 std::uint64_t seed = default_seed,
+                                 const std::filesystem::path& dir =
+                                     CacheDirectory()) noexcept
+    -> std::vector<int> {
+  const auto path = dir / (std::string(Name(distribution)) + '_' +
+                           std::to_string(n) + '_' + std::to_string(seed) +
+                           ".keys");
+  const auto bytes = static_cast<std::streamsize>(n * sizeof(int));
+  auto v = std::vector<int>(n);
+  if (auto in = std::ifstream(path, std::ios::binary)) {
+    if (in.read(reinterpret_cast<char*>(v.data()), bytes) and
+        in.peek() == std::ifstream::traits_type::eof()) {
+      return v;
+    }
+  }
+
+  v = Generate(distribution, n, seed);
+  auto error = std::error_code();
+  std::filesystem::create_directories(dir, error);
+  // written aside and renamed, so a concurrent reader never sees a partial
+  // file under the final name
+  auto partial = path;
+  partial += ".partial";
+  if (auto out = std::ofstream(partial, std::ios::binary | std::ios::trunc)) {
+    if (out.write(reinterpret_cast<const char*>(v.data()), bytes) and
+        (out.close(), not out.fail())) {
+      std::filesystem::rename(partial, path, error);
+    }
+  }
+  std::filesystem::remove(partial, error);
+  return v;
+}
+
+}  // namespace soft_heap::workload
@@ -0,0 +1,188 @@
+// Tail latency of single heap operations. Each Insert and ExtractMin is timed
+// on its own and recorded in a LatencyHistogram per operation type, so the
+// rare Sift cascades and large combines that amortized benchmarks average
+// away show up in the p99, p99.9 and max columns.
+//
+// Usage: soft_heap_latency [n ...]
+// Runs every workload at each heap size n, by default 2^16, 2^20 and 2^23.
+// Times include one steady_clock read, whose own cost is the "clock" row.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <queue>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "flat_soft_heap.hpp"
+#include "inline_list.hpp"
+#include "latency_histogram.hpp"
+#include "node_pool.hpp"
+#include "policies.hpp"
+#include "soft_heap.hpp"
+#include "workload.hpp"
+
+namespace soft_heap::latency {
+
+using Clock = std::chrono::steady_clock;
+
+// Timed operations per steady-state workload, independent of the heap size
+constexpr std::size_t steady_ops = std::size_t{1} << 20;
+
+// Keeps the extracted keys alive without a benchmark library
+inline volatile std::int64_t sink = 0;
+
+// The baseline: std::priority_queue turned into a min-heap
+template <class Element>
+class StlMinHeap {
+ public:
+  StlMinHeap() = default;
+  StlMinHeap(auto first, auto last) : queue(first, last) {}
+
+  void Insert(Element e) { queue.push(std::move(e)); }
+
+  auto ExtractMin() -> Element {
+    auto e = queue.top();
+    queue.pop();
+    return e;
+  }
+
+  [[nodiscard]] auto size() const noexcept { return queue.size(); }
+
+ private:
+  std::priority_queue<Element, std::vector<Element>, std::greater<>> queue;
+};
+
+template <class F>
+void Time(LatencyHistogram& histogram, F&& op) {
+  const auto start = Clock::now();
+  op();
+  const auto end = Clock::now();
+  histogram.Record(static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+          .count()));
+}
+
+void PrintHeader() {
+  std::printf("%-26s %10s %-8s %-8s %9s %7s %7s %7s %9s %9s\n", "heap", "n",
+              "workload", "op", "count", "mean", "p50", "p99", "p99.9",
+              "max");
+}
+
+void Print(std::string_view heap, std::size_t n, std::string_view workload,
+           std::string_view op, const LatencyHistogram& histogram) {
+  std::printf("%-26.*s %10zu %-8.*s %-8.*s %9llu %7.0f %7llu %7llu %9llu "
+              "%9llu\n",
+              static_cast<int>(heap.size()), heap.data(), n,
+              static_cast<int>(workload.size()), workload.data(),
+              static_cast<int>(op.size()), op.data(),
+              static_cast<unsigned long long>(histogram.count()),
+              histogram.mean(),
+              static_cast<unsigned long long>(histogram.Percentile(0.5)),
+              static_cast<unsigned long long>(histogram.Percentile(0.99)),
+              static_cast<unsigned long long>(histogram.Percentile(0.999)),
+              static_cast<unsigned long long>(histogram.max()));
+}
+
+// Every workload at size n:
+//  - fill: n inserts into an empty heap
+//  - drain: n extractions from a bulk-built heap
+//  - hold: steady_ops rounds of extracting the minimum x and inserting x
+//    plus a uniform increment, on a heap of n keys
+//  - mixed: steady_ops inserts or extractions, each with probability 1/2,
+//    starting from a heap of n keys
+template <class Heap>
+void Run(std::string_view name, std::size_t n) {
+  const auto keys = workload::Cached(workload::Distribution::kUniform, n);
+  auto gen = std::mt19937_64(workload::default_seed);
+  const auto bound = static_cast<int>(n);
+  const auto uniform = [&] {
+    return static_cast<int>(gen() % static_cast<std::uint64_t>(bound)) + 1;
+  };
+
+  {
+    auto insert = LatencyHistogram();
+    auto heap = Heap();
+    for (auto key : keys) {
+      Time(insert, [&] { heap.Insert(key); });
+    }
+    Print(name, n, "fill", "insert", insert);
+  }
+  {
+    auto extract = LatencyHistogram();
+    auto heap = Heap(keys.begin(), keys.end());
+    for (std::size_t i = 0; i < n; ++i) {
+      Time(extract, [&] { sink = heap.ExtractMin(); });
+    }
+    Print(name, n, "drain", "extract", extract);
+  }
+  {
+    auto insert = LatencyHistogram();
+    auto extract = LatencyHistogram();
+    auto heap = Heap(keys.begin(), keys.end());
+    for (std::size_t i = 0; i < steady_ops; ++i) {
+      auto x = 0;
+      Time(extract, [&] { x = heap.ExtractMin(); });
+      const auto key = x + uniform();
+      Time(insert, [&] { heap.Insert(key); });
+    }
+    sink = static_cast<std::int64_t>(heap.size());
+    Print(name, n, "hold", "extract", extract);
+    Print(name, n, "hold", "insert", insert);
+  }
+  {
+    auto insert = LatencyHistogram();
+    auto extract = LatencyHistogram();
+    auto heap = Heap(keys.begin(), keys.end());
+    for (std::size_t i = 0; i < steady_ops; ++i) {
+      if ((gen() & 1) == 0 or heap.size() == 0) {
+        const auto key = uniform();
+        Time(insert, [&] { heap.Insert(key); });
+      } else {
+        Time(extract, [&] { sink = heap.ExtractMin(); });
+      }
+    }
+    Print(name, n, "mixed", "extract", extract);
+    Print(name, n, "mixed", "insert", insert);
+  }
+}
+
+// What Time adds to every sample: two clock reads around nothing
+void RunClock() {
+  auto clock = LatencyHistogram();
+  for (std::size_t i = 0; i < steady_ops; ++i) {
+    Time(clock, [] {});
+  }
+  Print("clock", 0, "empty", "-", clock);
+}
+
+}  // namespace soft_heap::latency
+
+auto main(int argc, char* argv[]) -> int {
+  using namespace soft_heap;
+  using latency::Run;
+
+  auto sizes = std::vector<std::size_t>();
+  for (int i = 1; i < argc; ++i) {
+    sizes.push_back(std::stoull(argv[i]));
+  }
+  if (sizes.empty()) {
+    sizes = {std::size_t{1} << 16, std::size_t{1} << 20, std::size_t{1} << 23};
+  }
+
+  latency::PrintHeader();
+  latency::RunClock();
+  for (auto n : sizes) {
+    Run<SoftHeap<int>>("SoftHeap", n);
+    Run<SoftHeap<int, InlineList<int>, 8, policy::PoolAllocation<>,
+                 policy::RankedRoots>>("SoftHeap<pool,ranked>", n);
+    Run<FlatSoftHeap<int>>("FlatSoftHeap", n);
+    Run<FlatSoftHeap<int, InlineList<int>, 8, policy::RankedRoots>>(
+        "FlatSoftHeap<ranked>", n);
+    Run<latency::StlMinHeap<int>>("std::priority_queue", n);
+  }
+  return 0;
+}
@@ -13,19 +13,10 @@
 #include "node.hpp"
 #include "soft_heap.hpp"
 #include "tree.hpp"
+#include "workload.hpp"
 
-[[nodiscard]] auto generate_rand(int n) noexcept {
-  auto v = std::vector<int>(n);
-  std::iota(v.begin(), v.end(), 1);  // 1,2,...,size-1
-  std::shuffle(v.begin(), v.end(), std::mt19937(std::random_device()()));
-  return v;
-}
-
-[[nodiscard]] auto rand_int(int start, int stop) noexcept {
-  auto generator = std::mt19937(std::random_device()());
-  auto dist = std::uniform_int_distribution<int>(start, stop);
-  return dist(generator);
-}
+using soft_heap::workload::generate_rand;
+using soft_heap::workload::rand_int;
 
 void test_STL(int size) {
   auto rand = generate_rand(size);
@@ -0,0 +1,149 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "inline_list.hpp"
+#include "order.hpp"
+#include "policies.hpp"
+#include "soft_heap.hpp"
+
+namespace soft_heap {
+
+// A shared SoftHeap behind one mutex, fed through per-thread Producers. A
+// producer collects inserts in a private buffer without any synchronization,
+// bulk-builds the buffer into a SoftHeap of its own off the lock, and
+// publishes it with a single Meld. N contended inserts become one contended
+// meld.
+//
+// Staleness guarantee: an element reaches consumers at the latest
+//  - after buffer_capacity - 1 further inserts by its producer,
+//  - at its producer's next Insert after any consumer called RequestFlush,
+//  - or when its producer calls Flush or is destroyed.
+// All three are driven by the producer; consumers never reach into a
+// buffer. There is no bound in time: the elements of a producer that stops
+// inserting stay invisible until it calls Flush or is destroyed, however
+// often consumers RequestFlush, so producers that may go idle must Flush.
+template <policy::TotalOrdered Element, int inverse_epsilon = 8,
+          policy::ElementOrder<Element> Order = policy::NaturalOrder>
+class BufferedSoftHeap {
+ public:
+  using HeapType =
+      SoftHeap<Element, InlineList<Element>, inverse_epsilon,
+               policy::HeapAllocation, policy::LinkedRoots, Order>;
+
+  // Owned by one thread at a time; must not outlive its heap. A moved-from
+  // producer is detached: it may be destroyed, assigned to or flushed, which
+  // does nothing, but not inserted into.
+  class Producer {
+   public:
+    Producer(BufferedSoftHeap& shared, std::size_t buffer_capacity) noexcept
+        : shared(&shared),
+          capacity(buffer_capacity),
+          seen_epoch(shared.flush_epoch.load(std::memory_order_relaxed)) {
+      buffer.reserve(capacity);
+    }
+
+    Producer(const Producer&) = delete;
+    auto operator=(const Producer&) -> Producer& = delete;
+    Producer(Producer&& that) noexcept
+        : shared(std::exchange(that.shared, nullptr)),
+          capacity(that.capacity),
+          seen_epoch(that.seen_epoch),
+          buffer(std::move(that.buffer)) {}
+
+    auto operator=(Producer&& that) noexcept -> Producer& {
+      if (&that != this) {
+        Flush();
+        shared = std::exchange(that.shared, nullptr);
+        capacity = that.capacity;
+        seen_epoch = that.seen_epoch;
+        buffer = std::move(that.buffer);
+      }
+      return *this;
+    }
+
+    ~Producer() { Flush(); }
+
+    // Requires a producer that has not been moved from
+    void Insert(Element e) noexcept {
+      buffer.push_back(std::move(e));
+      const auto epoch = shared->flush_epoch.load(std::memory_order_relaxed);
+      if (buffer.size() >= capacity or epoch != seen_epoch) {
+        seen_epoch = epoch;
+        Flush();
+      }
+    }
+
+    // Publishes the buffer; a no-op when it is empty or detached
+    void Flush() noexcept {
+      if (shared == nullptr or buffer.empty()) {
+        return;
+      }
+      auto local = HeapType(std::make_move_iterator(buffer.begin()),
+                            std::make_move_iterator(buffer.end()));
+      buffer.clear();
+      shared->Publish(std::move(local));
+    }
+
+    [[nodiscard]] auto buffered() const noexcept { return buffer.size(); }
+
+   private:
+    BufferedSoftHeap* shared;
+    std::size_t capacity;
+    std::uint64_t seen_epoch;
+    std::vector<Element> buffer;
+  };
+
+  explicit BufferedSoftHeap(std::size_t buffer_capacity = 256) noexcept
+      : buffer_capacity(buffer_capacity) {}
+
+  [[nodiscard]] auto MakeProducer() noexcept -> Producer {
+    return Producer(*this, buffer_capacity);
+  }
+
+  // Asks every producer to publish at its next Insert. Only a hint: a
+  // producer that does not insert again keeps its buffer until it flushes.
+  void RequestFlush() noexcept {
+    flush_epoch.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Inserts straight into the shared heap, bypassing any buffer
+  void Insert(Element e) noexcept {
+    const auto lock = std::lock_guard(mutex);
+    heap.Insert(std::move(e));
+  }
+
+  // Nothing if no element has been published yet
+  [[nodiscard]] auto ExtractMin() noexcept -> std::optional<Element> {
+    const auto lock = std::lock_guard(mutex);
+    if (heap.size() == 0) {
+      return std::nullopt;
+    }
+    return heap.ExtractMin();
+  }
+
+  // Published elements, not counting any still buffered
+  [[nodiscard]] auto size() noexcept -> std::size_t {
+    const auto lock = std::lock_guard(mutex);
+    return heap.size();
+  }
+
+ private:
+  void Publish(HeapType&& local) noexcept {
+    const auto lock = std::lock_guard(mutex);
+    heap.Meld(std::move(local));
+  }
+
+  std::mutex mutex;
+  HeapType heap;
+  std::size_t buffer_capacity;
+  std::atomic<std::uint64_t> flush_epoch = 0;
+};
+
+}  // namespace soft_heap
@@ -0,0 +1,158 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "inline_list.hpp"
+#include "order.hpp"
+#include "policies.hpp"
+#include "soft_heap.hpp"
+
+namespace soft_heap {
+
+// Relaxed concurrent priority queue in the MultiQueue style: shards_per_thread
+// soft heaps per thread, each behind a try-lock. Insert goes to a random
+// shard; ExtractMin locks two random shards and pops from the one with the
+// smaller top. The result is close to the global minimum with high
+// probability, on top of the corruption every shard already allows. Every
+// lock is only ever tried, so no thread blocks on a lock held by another;
+// a contended thread moves on to other shards or retries instead.
+template <policy::TotalOrdered Element, int inverse_epsilon = 8,
+          policy::ElementOrder<Element> Order = policy::NaturalOrder>
+class ConcurrentSoftHeap {
+ public:
+  using HeapType =
+      SoftHeap<Element, InlineList<Element>, inverse_epsilon,
+               policy::HeapAllocation, policy::LinkedRoots, Order>;
+
+  explicit ConcurrentSoftHeap(
+      std::size_t num_threads = std::thread::hardware_concurrency(),
+      std::size_t shards_per_thread = 2) noexcept
+      : shards(std::max<std::size_t>(
+            2, std::max<std::size_t>(1, num_threads) * shards_per_thread)) {}
+
+  // Yields after as many failed tries as there are shards, so threads that
+  // outnumber the shards let the lock holders run instead of spinning
+  void Insert(Element e) noexcept {
+    for (std::size_t tries = 1;; ++tries) {
+      auto& shard = shards[RandomShard()];
+      if (auto lock = std::unique_lock(shard.mutex, std::try_to_lock)) {
+        shard.heap.Insert(std::move(e));
+        shard.size.store(shard.heap.size(), std::memory_order_relaxed);
+        num_elements.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      if (tries % shards.size() == 0) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  // The smaller top of two sampled shards. Returns nothing only once every
+  // shard was seen empty.
+  [[nodiscard]] auto ExtractMin() noexcept -> std::optional<Element> {
+    for (int attempt = 0; attempt < max_attempts; ++attempt) {
+      if (num_elements.load(std::memory_order_relaxed) == 0) {
+        break;
+      }
+      const auto i = RandomShard();
+      auto j = RandomShard();
+      j = (j == i) ? (j + 1) % shards.size() : j;
+      auto lock_i = std::unique_lock(shards[i].mutex, std::try_to_lock);
+      if (not lock_i) {
+        continue;
+      }
+      auto lock_j = std::unique_lock(shards[j].mutex, std::try_to_lock);
+      auto* best = Better(&shards[i], lock_j ? &shards[j] : nullptr);
+      if (best != nullptr) {
+        return Pop(*best);
+      }
+    }
+    return Sweep();
+  }
+
+  // Elements inserted and not yet extracted, as of some recent moment
+  [[nodiscard]] auto size() const noexcept -> std::size_t {
+    return num_elements.load(std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] auto empty() const noexcept { return size() == 0; }
+
+  [[nodiscard]] auto num_shards() const noexcept { return shards.size(); }
+
+ private:
+  // Two-choice sampling gives up and falls back to a sweep after this many
+  // rounds of contended or empty shards
+  static constexpr int max_attempts = 16;
+
+  // One cache line apiece so that locking a shard does not bounce its
+  // neighbours' lines between cores
+  struct alignas(64) Shard {
+    std::mutex mutex;
+    HeapType heap;
+    std::atomic<std::size_t> size = 0;  // readable without the lock
+  };
+
+  // The non-empty shard with the smaller top; both must be locked
+  [[nodiscard]] static auto Better(Shard* x, Shard* y) noexcept -> Shard* {
+    if (y == nullptr or y->heap.size() == 0) {
+      return x->heap.size() == 0 ? nullptr : x;
+    }
+    if (x->heap.size() == 0) {
+      return y;
+    }
+    return Order::Less(y->heap.TopCKey(), x->heap.TopCKey()) ? y : x;
+  }
+
+  auto Pop(Shard& shard) noexcept -> Element {
+    auto e = shard.heap.ExtractMin();
+    shard.size.store(shard.heap.size(), std::memory_order_relaxed);
+    num_elements.fetch_sub(1, std::memory_order_relaxed);
+    return e;
+  }
+
+  // Passes over every shard for a nearly empty heap, popping from the first
+  // non-empty one it can lock. A pass that had to skip a locked shard is
+  // repeated, so nothing is returned only once every shard was seen empty.
+  auto Sweep() noexcept -> std::optional<Element> {
+    for (;;) {
+      auto contended = false;
+      const auto first = RandomShard();
+      for (std::size_t k = 0; k < shards.size(); ++k) {
+        auto& shard = shards[(first + k) % shards.size()];
+        if (shard.size.load(std::memory_order_relaxed) == 0) {
+          continue;
+        }
+        auto lock = std::unique_lock(shard.mutex, std::try_to_lock);
+        if (not lock) {
+          contended = true;
+        } else if (shard.heap.size() != 0) {
+          return Pop(shard);
+        }
+      }
+      if (not contended) {
+        return std::nullopt;
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  [[nodiscard]] auto RandomShard() const noexcept -> std::size_t {
+    thread_local auto rng = std::minstd_rand(
+        std::random_device()() ^
+        std::hash<std::thread::id>()(std::this_thread::get_id()));
+    return rng() % shards.size();
+  }
+
+  std::vector<Shard> shards;
+  std::atomic<std::size_t> num_elements = 0;
+};
+
+}  // namespace soft_heap
@@ -0,0 +1,229 @@
+#pragma once
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "flat_node.hpp"
+#include "order.hpp"
+#include "policies.hpp"
+
+namespace soft_heap {
+
+namespace detail {
+
+// Node storage of a FlatTree, one FlatNode per slot. Both layouts expose the
+// same per-slot accessors (ckey, elements, meta) so FlatTree is written once.
+template <class Element, class List, int inverse_epsilon, class Order>
+class NodeArray {
+ public:
+  using Key = typename Order::template KeyType<Element>;
+  using NodeType = FlatNode<Element, List, inverse_epsilon, Order>;
+
+  [[nodiscard]] constexpr auto ssize() const noexcept {
+    return std::ssize(nodes);
+  }
+
+  [[nodiscard]] constexpr auto ckey(std::ptrdiff_t idx) noexcept -> Key& {
+    return GetCKey<Key>(nodes[idx].ckey);
+  }
+
+  [[nodiscard]] constexpr auto ckey(std::ptrdiff_t idx) const noexcept
+      -> const Key& {
+    return GetCKey<Key>(nodes[idx].ckey);
+  }
+
+  // Gives the slot a key, which an empty node may not have yet
+  constexpr void set_ckey(std::ptrdiff_t idx, const Key& key) noexcept {
+    nodes[idx].ckey = key;
+  }
+
+  // Drops the key and element storage of a slot that became a hole
+  constexpr void vacate(std::ptrdiff_t idx) noexcept {
+    ResetCKey<Key>(nodes[idx].ckey);
+    nodes[idx].elements = List();
+  }
+
+  [[nodiscard]] constexpr auto elements(std::ptrdiff_t idx) noexcept
+      -> List& {
+    return nodes[idx].elements;
+  }
+
+  [[nodiscard]] constexpr auto elements(std::ptrdiff_t idx) const noexcept
+      -> const List& {
+    return nodes[idx].elements;
+  }
+
+  // rank, size, ckey_present and num_uncorrupted of the slot
+  [[nodiscard]] constexpr auto meta(std::ptrdiff_t idx) noexcept
+      -> NodeType& {
+    return nodes[idx];
+  }
+
+  [[nodiscard]] constexpr auto meta(std::ptrdiff_t idx) const noexcept
+      -> const NodeType& {
+    return nodes[idx];
+  }
+
+  [[nodiscard]] constexpr auto capacity() const noexcept {
+    return static_cast<std::ptrdiff_t>(nodes.capacity());
+  }
+
+  constexpr void reserve(std::ptrdiff_t count) noexcept {
+    nodes.reserve(count);
+  }
+
+  constexpr void emplace_back(Element&& element) noexcept {
+    nodes.emplace_back(std::forward<Element>(element));
+  }
+
+  // An empty node, to be filled by a sift
+  constexpr void emplace_back(int rank, int size) noexcept {
+    nodes.emplace_back(rank, size);
+  }
+
+  // Moves slots [first, last) of that to the back
+  constexpr void append(NodeArray& that, std::ptrdiff_t first,
+                        std::ptrdiff_t last) noexcept {
+    nodes.insert(nodes.end(),
+                 std::make_move_iterator(std::next(that.nodes.begin(), first)),
+                 std::make_move_iterator(std::next(that.nodes.begin(), last)));
+  }
+
+  constexpr void swap(NodeArray& that) noexcept { nodes.swap(that.nodes); }
+
+ private:
+  std::vector<NodeType> nodes;
+};
+
+// Structure-of-arrays node storage: a dense ckey array, a parallel array of
+// rank/size metadata and the element lists held apart, so comparisons
+// between nodes only stream through keys.
+template <class Element, class List, int inverse_epsilon, class Order>
+class SplitArrays {
+ public:
+  using Key = typename Order::template KeyType<Element>;
+
+  struct Meta {
+    int rank;
+    int size;
+    bool ckey_present;
+    int num_uncorrupted;
+  };
+
+  [[nodiscard]] constexpr auto ssize() const noexcept {
+    return std::ssize(keys);
+  }
+
+  [[nodiscard]] constexpr auto ckey(std::ptrdiff_t idx) noexcept -> Key& {
+    return GetCKey<Key>(keys[idx]);
+  }
+
+  [[nodiscard]] constexpr auto ckey(std::ptrdiff_t idx) const noexcept
+      -> const Key& {
+    return GetCKey<Key>(keys[idx]);
+  }
+
+  constexpr void set_ckey(std::ptrdiff_t idx, const Key& key) noexcept {
+    keys[idx] = key;
+  }
+
+  constexpr void vacate(std::ptrdiff_t idx) noexcept {
+    ResetCKey<Key>(keys[idx]);
+    lists[idx] = List();
+  }
+
+  [[nodiscard]] constexpr auto elements(std::ptrdiff_t idx) noexcept
+      -> List& {
+    return lists[idx];
+  }
+
+  [[nodiscard]] constexpr auto elements(std::ptrdiff_t idx) const noexcept
+      -> const List& {
+    return lists[idx];
+  }
+
+  [[nodiscard]] constexpr auto meta(std::ptrdiff_t idx) noexcept -> Meta& {
+    return metas[idx];
+  }
+
+  [[nodiscard]] constexpr auto meta(std::ptrdiff_t idx) const noexcept
+      -> const Meta& {
+    return metas[idx];
+  }
+
+  [[nodiscard]] constexpr auto capacity() const noexcept {
+    return static_cast<std::ptrdiff_t>(keys.capacity());
+  }
+
+  constexpr void reserve(std::ptrdiff_t count) noexcept {
+    keys.reserve(count);
+    metas.reserve(count);
+    lists.reserve(count);
+  }
+
+  constexpr void emplace_back(Element&& element) noexcept {
+    lists.push_back(List{std::forward<Element>(element)});
+    keys.push_back(Order::Key(*lists.back().begin()));
+    metas.push_back({0, 1, true, 1});
+  }
+
+  // An empty node, keyless until the sift that fills it
+  constexpr void emplace_back(int rank, int size) noexcept {
+    lists.emplace_back();
+    keys.emplace_back();
+    metas.push_back({rank, size, true, 0});
+  }
+
+  constexpr void append(SplitArrays& that, std::ptrdiff_t first,
+                        std::ptrdiff_t last) noexcept {
+    Append(keys, that.keys, first, last);
+    Append(metas, that.metas, first, last);
+    Append(lists, that.lists, first, last);
+  }
+
+  constexpr void swap(SplitArrays& that) noexcept {
+    keys.swap(that.keys);
+    metas.swap(that.metas);
+    lists.swap(that.lists);
+  }
+
+ private:
+  template <class T>
+  static constexpr void Append(std::vector<T>& into, std::vector<T>& from,
+                               std::ptrdiff_t first,
+                               std::ptrdiff_t last) noexcept {
+    into.insert(into.end(),
+                std::make_move_iterator(std::next(from.begin(), first)),
+                std::make_move_iterator(std::next(from.begin(), last)));
+  }
+
+  std::vector<CKeySlot<Key>> keys;
+  std::vector<Meta> metas;
+  std::vector<List> lists;
+};
+
+}  // namespace detail
+
+namespace policy {
+
+// Default: one array of whole FlatNodes
+struct NodeArrayLayout {
+  template <class Element, class List, int inverse_epsilon, class Order>
+  using Storage = detail::NodeArray<Element, List, inverse_epsilon, Order>;
+};
+
+// Keys, metadata and element lists in separate parallel arrays
+struct SplitArrayLayout {
+  template <class Element, class List, int inverse_epsilon, class Order>
+  using Storage = detail::SplitArrays<Element, List, inverse_epsilon, Order>;
+};
+
+template <class Layout>
+concept FlatLayout = requires {
+  typename Layout::template Storage<int, std::vector<int>, 8, NaturalOrder>;
+};
+
+}  // namespace policy
+
+}  // namespace soft_heap
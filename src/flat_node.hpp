@@ -2,34 +2,96 @@
 #include <algorithm>
 #include <cmath>
 #include <compare>
+#include <concepts>
 #include <iostream>
 #include <iterator>
+#include <optional>
 #include <type_traits>
 
+#include "order.hpp"
 #include "policies.hpp"
 #include "utility.hpp"
 
 namespace soft_heap {
 
+namespace detail {
+
+// Storage for the ckey of a flat node. An empty node has no key until its
+// first sift, and a hole none at all, so keys without a default constructor
+// are held in an optional; any other key is stored bare, which keeps a split
+// layout's key array dense. Only occupied, filled slots are ever read.
+template <class Key>
+using CKeySlot = std::conditional_t<std::default_initializable<Key>, Key,
+                                    std::optional<Key>>;
+
+template <class Key>
+[[nodiscard]] constexpr auto GetCKey(CKeySlot<Key>& slot) noexcept -> Key& {
+  if constexpr (std::default_initializable<Key>) {
+    return slot;
+  } else {
+    return *slot;
+  }
+}
+
+template <class Key>
+[[nodiscard]] constexpr auto GetCKey(const CKeySlot<Key>& slot) noexcept
+    -> const Key& {
+  if constexpr (std::default_initializable<Key>) {
+    return slot;
+  } else {
+    return *slot;
+  }
+}
+
+// Drops the key of a slot that became a hole
+template <class Key>
+constexpr void ResetCKey(CKeySlot<Key>& slot) noexcept {
+  if constexpr (not std::default_initializable<Key>) {
+    slot.reset();
+  }
+}
+
+}  // namespace detail
+
 template <policy::TotalOrdered Element, policy::TotalOrderedContainer List,
-          int inverse_epsilon>
+          int inverse_epsilon,
+          policy::ElementOrder<Element> Order = policy::NaturalOrder>
 class FlatNode {
  public:
+  using Key = typename Order::template KeyType<Element>;
+
   FlatNode() = delete;
 
   constexpr explicit FlatNode(Element&& element) noexcept
       : elements(List{std::forward<Element>(element)}),
-        ckey(std::forward<Element>(element)),
+        ckey(Order::Key(*elements.begin())),
         rank(0),
         size(1),
-        ckey_present(true) {}
+        ckey_present(true),
+        num_uncorrupted(1) {}
 
   constexpr explicit FlatNode(int rank, int size, List&& list) noexcept
       : elements(std::move(list)),
-        ckey(*std::max_element(elements.begin(), elements.end())),
+        ckey(Order::Key(*std::max_element(
+            elements.begin(), elements.end(),
+            [](const auto& x, const auto& y) {
+              return Order::Less(Order::Key(x), Order::Key(y));
+            }))),
         rank(rank),
         size(size),
-        ckey_present(true) {}
+        ckey_present(true),
+        num_uncorrupted(static_cast<int>(
+            std::count_if(elements.begin(), elements.end(), [&](auto&& x) {
+              return Order::Equivalent(Order::Key(x),
+                                       detail::GetCKey<Key>(ckey));
+            }))) {}
+
+  // Empty node of the given rank, filled by the next sift
+  constexpr explicit FlatNode(int rank, int size) noexcept
+      : rank(rank),
+        size(size),
+        ckey_present(true),
+        num_uncorrupted(0) {}
 
   constexpr explicit FlatNode(const FlatNode& node1,
                               const FlatNode& node2) noexcept
@@ -37,7 +99,8 @@ class FlatNode {
         size((rank > ConstCeil(std::log2(inverse_epsilon)) + 5)
                  ? std::max(node2.rank, node1.rank) + 1
                  : 1),
-        ckey_present(true) {}
+        ckey_present(true),
+        num_uncorrupted(0) {}
 
   [[nodiscard]] constexpr auto back() const noexcept -> Element {
     return elements.back();
@@ -46,13 +109,15 @@ class FlatNode {
   constexpr void pop_back() noexcept { elements.pop_back(); }
 
   constexpr auto operator<=>(const FlatNode& that) const noexcept
-      -> std::strong_ordering {
-    return this->ckey <=> that.ckey;
+      -> std::weak_ordering {
+    return Order::Order(detail::GetCKey<Key>(ckey),
+                        detail::GetCKey<Key>(that.ckey));
   }
 
   friend auto operator<<(std::ostream& out, FlatNode node) noexcept
       -> std::ostream& {
-    out << "Node: " << node.ckey << " (ckey), rank: " << node.rank
+    out << "Node: " << detail::GetCKey<Key>(node.ckey)
+        << " (ckey), rank: " << node.rank
         << ", size: " << node.size;
     out << "\nwith elements: ";
     std::copy(node.elements.begin(), node.elements.end(),
@@ -61,10 +126,11 @@ class FlatNode {
   }
 
   List elements;
-  Element ckey;
+  detail::CKeySlot<Key> ckey;
   int rank;
   int size;
   bool ckey_present;
+  int num_uncorrupted;  // elements whose key still equals ckey
 };
 
 }  // namespace soft_heap
@@ -7,184 +7,264 @@
 #include <iterator>
 #include <list>
 #include <memory>
+#include <optional>
 #include <set>
+#include <span>
 #include <type_traits>
 
 #include "flat_tree.hpp"
+#include "inline_list.hpp"
+#include "order.hpp"
 #include "policies.hpp"
+#include "ranked_trees.hpp"
+#include "root_min.hpp"
+#include "stats.hpp"
+#include "tombstones.hpp"
 #include "utility.hpp"
 
 namespace soft_heap {
 
 template <policy::TotalOrdered Element,
-          policy::TotalOrderedContainer List = std::vector<Element>,
-          int inverse_epsilon = 8>
+          policy::TotalOrderedContainer List = InlineList<Element>,
+          int inverse_epsilon = 8,
+          policy::RootContainer Roots = policy::LinkedRoots,
+          policy::ElementOrder<Element> Order = policy::NaturalOrder,
+          policy::FlatLayout Layout = policy::NodeArrayLayout,
+          policy::RootMinTracking Tracking = policy::AutoMinRoots,
+          policy::OperationStats Stats = policy::NoStats,
+          policy::TombstoneTracking Tombstones = policy::NoTombstones>
 class FlatSoftHeap {
  public:
-  using TreeList = std::list<FlatTree<Element, List, inverse_epsilon>>;
+  using TreeType =
+      FlatTree<Element, List, inverse_epsilon, Roots, Order, Layout>;
+  using Key = typename Order::template KeyType<Element>;
+  using TreeList = typename Roots::template Container<TreeType>;
   using TreeListIt = typename TreeList::iterator;
 
+  // Whether the minimum root is found by scanning root_keys, see SoftHeap
+  static constexpr bool scan_roots =
+      Tracking::template scan<Roots, Key, Order>;
+  static_assert(not scan_roots or Roots::rank_indexed,
+                "ScanMinRoots needs rank-indexed roots");
+
+  constexpr FlatSoftHeap() noexcept : epsilon(1.0 / inverse_epsilon) {}
+
   constexpr explicit FlatSoftHeap(Element&& element) noexcept
-      : epsilon(1.0 / inverse_epsilon), c_size(1) {
-    trees.emplace_back(std::forward<Element>(element));
-    trees.begin()->min_ckey = trees.begin();
+      : epsilon(1.0 / inverse_epsilon) {
+    Insert(std::forward<Element>(element));
   }
 
+  // Bulk build, see SoftHeap: one carrying pass, one suffix-min pass
   constexpr FlatSoftHeap(std::input_iterator auto first,
-                         std::input_iterator auto last) noexcept
-      : FlatSoftHeap(std::move(*first)) {
-    std::for_each(std::next(first), last,
-                  [&](auto&& e) { Insert(std::forward<Element>(e)); });
+                         std::input_iterator auto last)
+      : epsilon(1.0 / inverse_epsilon) {
+    auto forest = RankedTrees<TreeType>();
+    for (; first != last; ++first, ++c_size) {
+      counters.OnInsert();
+      forest.Carry(0, TreeType(Element(*first)), Link());
+    }
+    if constexpr (Roots::rank_indexed) {
+      trees = std::move(forest);
+    } else {
+      for (auto& tree : forest) {
+        trees.push_back(std::move(tree));
+      }
+    }
+    if (not trees.empty()) {
+      UpdateSuffixMin(std::prev(trees.end()));
+    }
+  }
+
+  // Returns a handle under a tracking Tombstones policy, see SoftHeap
+  constexpr auto Insert(Element e) noexcept {
+    if constexpr (Tombstones::tracked) {
+      const auto handle = handles.Track(e);
+      Push(std::move(e));
+      PurgeTop();
+      return handle;
+    } else {
+      Push(std::move(e));
+    }
   }
 
-  constexpr void Insert(Element e) noexcept {
+  constexpr void Push(Element e) noexcept
+    requires Roots::rank_indexed
+  {
     ++c_size;
-    auto first_tree = trees.begin();
-    if (std::ssize(trees) != 0 and first_tree->rank() == 0) {
-      auto& node_heap = first_tree->node_heap;
-      node_heap.emplace_back(std::move(e));
-      auto& new_root =
-          node_heap[0] > node_heap[1] ? node_heap[1] : node_heap[0];
-      new_root.size = 1;
-      ++new_root.rank;
-      for (auto tree = trees.begin(); tree != trees.end();
-           std::advance(tree, 1)) {
-        auto&& next_tree = std::next(tree);
-        if (next_tree != trees.end() and tree->rank() == next_tree->rank()) {
-          auto& node_heap = tree->node_heap;
-          auto& next_heap = next_tree->node_heap;
-          node_heap.insert(node_heap.end(),
-                           std::make_move_iterator(next_heap.begin()),
-                           std::make_move_iterator(next_heap.end()));
-          auto& new_root =
-              node_heap[0] > next_heap[0] ? next_heap[0] : node_heap[0];
-          new_root.size =
-              (tree->rank() > ConstCeil(std::log2(inverse_epsilon)) + 5)
-                  ? new_root.size + 1
-                  : 1;
-          ++new_root.rank;
-          tree->SiftInsert();
-          trees.erase(next_tree);
-          std::advance(tree, -1);
-        } else if (tree->rank() > 0) {
-          UpdateSuffixMin(tree);
-          return;
-        }
-      }
+    counters.OnInsert();
+    UpdateSuffixMin(trees.Carry(0, TreeType(std::move(e)), Link()));
+  }
+
+  constexpr void Push(Element e) noexcept {
+    ++c_size;
+    counters.OnInsert();
+    trees.emplace_front(std::move(e));
+    // The older tree keeps its slot and takes the carry as its right
+    // subtree, the way RankedTrees::Carry and the bulk build link
+    auto tree = trees.begin();
+    for (auto next = std::next(tree);
+         next != trees.end() and tree->rank() == next->rank();
+         tree = trees.erase(tree), next = std::next(tree)) {
+      Link()(*next, std::move(*tree), next->rank() + 1);
+    }
+    UpdateSuffixMin(tree);
+  }
+
+  // Bulk build plus a single Meld, see SoftHeap
+  constexpr void InsertRange(std::input_iterator auto first,
+                             std::input_iterator auto last) {
+    auto burst = FlatSoftHeap(first, last);
+    if (not burst.trees.empty()) {
+      Absorb(std::move(burst));
+    }
+    if constexpr (Tombstones::tracked) {
+      PurgeTop();
+    }
+  }
+
+  // Heaps with handles only take in untracked entries, see SoftHeap::Meld
+  constexpr void Meld(FlatSoftHeap&& P) noexcept
+    requires(not Tombstones::tracked)
+  {
+    Absorb(std::move(P));
+  }
+
+  // Lazy deletion, see SoftHeap::Delete
+  constexpr auto Delete(Handle handle) noexcept -> bool
+    requires Tombstones::tracked
+  {
+    if (not handles.Live(handle)) {
+      return false;
+    }
+    handles.Release(handle);
+    --c_size;
+    ++num_dead;
+    if (num_dead > c_size) {
+      Purge();
     } else {
-      trees.emplace_front(std::forward<Element>(e));
-      trees.begin()->min_ckey = trees.begin();
+      PurgeTop();
     }
+    return true;
   }
 
-  constexpr void Meld(FlatSoftHeap&& P) noexcept {
-    if (P.rank() > rank()) {
-      trees.swap(P.trees);
+  constexpr auto DecreaseKey(Handle handle, Element e) noexcept
+      -> std::optional<Handle>
+    requires Tombstones::tracked
+  {
+    if (not Delete(handle)) {
+      return std::nullopt;
     }
-    const auto p_rank = P.rank();
-    trees.merge(P.trees);
+    return Insert(std::move(e));
+  }
 
-    for (auto tree = trees.begin(); tree != trees.end();
-         std::advance(tree, 1)) {
-      auto&& next_tree = std::next(tree);
-      if (next_tree != trees.end() and tree->rank() == next_tree->rank()) {
-        auto& node_heap = tree->node_heap;
-        auto& next_heap = next_tree->node_heap;
-        node_heap.insert(node_heap.end(),
-                         std::make_move_iterator(next_heap.begin()),
-                         std::make_move_iterator(next_heap.end()));
-        auto& new_root =
-            node_heap[0] > next_heap[0] ? next_heap[0] : node_heap[0];
-        new_root.size =
-            (tree->rank() > ConstCeil(std::log2(inverse_epsilon)) + 5)
-                ? new_root.size + 1
-                : 1;
-        ++new_root.rank;
-        tree->Sift();
-        trees.erase(next_tree);
-        std::advance(tree, -1);
-      } else if (tree->rank() > p_rank) {
-        UpdateSuffixMin(tree);
-        return;
-      }
+  [[nodiscard]] constexpr auto Contains(Handle handle) const noexcept -> bool
+    requires Tombstones::tracked
+  {
+    return handles.Live(handle);
+  }
+
+  [[nodiscard]] constexpr auto tombstones() const noexcept -> std::size_t
+    requires Tombstones::tracked
+  {
+    return num_dead;
+  }
+
+  // O(1) peeks and conditional extraction, see SoftHeap
+  [[nodiscard]] constexpr auto Top() const noexcept -> const Element& {
+    const auto& tree = MinRoot();
+    return tree.node_heap.elements(tree.root()).back();
+  }
+
+  [[nodiscard]] constexpr auto TopCKey() const noexcept -> const Key& {
+    return MinRoot().RootCKey();
+  }
+
+  [[nodiscard]] constexpr auto TryExtractMinIf(auto&& pred) noexcept
+      -> std::optional<Element> {
+    if (trees.empty() or not pred(Top())) {
+      return std::nullopt;
     }
-    UpdateSuffixMin(std::prev(trees.end()));
+    return ExtractMin();
   }
 
   [[nodiscard]] constexpr auto ExtractMin() noexcept {
-    const auto& min_tree = trees.front().min_ckey;
-    auto& x = min_tree->node_heap[0];
-    const auto first_elem = x.back();
-    x.pop_back();
-    if (2 * std::ssize(x.elements) < x.size) {
-      if (std::ssize(min_tree->node_heap) > 1) {  // Check if leaf
-        auto& min_node_heap = min_tree->node_heap;
-        const auto min_child_idx = std::ssize(min_node_heap) > 2 and
-                                           min_node_heap[1] > min_node_heap[2]
-                                       ? 2
-                                       : 1;
-        auto& min_elements = min_node_heap[min_child_idx].elements;
-        min_elements.insert(min_elements.end(),
-                            std::make_move_iterator(x.elements.begin()),
-                            std::make_move_iterator(x.elements.end()));
-        std::pop_heap(min_node_heap.begin(), min_node_heap.end(),
-                      std::greater<>());
-        min_node_heap.pop_back();
-        UpdateSuffixMin(min_tree);
-      } else if (x.elements.empty()) {
-        if (min_tree != trees.begin()) {
-          const auto prev = std::prev(min_tree);
-          trees.erase(min_tree);
-          UpdateSuffixMin(prev);
-        } else {
-          trees.erase(min_tree);
+    const auto min_tree = MinTree();
+    auto [first_elem, corrupted] = min_tree->TakeRootBack();
+    num_corrupted -= corrupted ? 1 : 0;
+    Refill(min_tree);
+    --c_size;
+    counters.OnExtract();
+    if constexpr (Tombstones::tracked) {
+      handles.Release(first_elem);
+      PurgeTop();
+    }
+    return first_elem;
+  }
+
+  // Batched ExtractMin, see SoftHeap
+  template <std::output_iterator<Element> Out>
+  constexpr auto ExtractMinBatch(Out out, std::size_t k) noexcept -> Out {
+    while (k != 0 and not trees.empty()) {
+      const auto min_tree = MinTree();
+      const auto& elements = min_tree->node_heap.elements(min_tree->root());
+      for (auto n = std::min(k, std::size(elements)); n != 0; --n) {
+        auto [element, corrupted] = min_tree->TakeRootBack();
+        num_corrupted -= corrupted ? 1 : 0;
+        if constexpr (Tombstones::tracked) {
+          if (handles.Dead(element)) {
+            --num_dead;
+            continue;
+          }
+          handles.Release(element);
         }
+        *out++ = std::move(element);
+        --k;
+        --c_size;
+        counters.OnExtract();
       }
+      Refill(min_tree);
     }
-    --c_size;
-    return first_elem;
+    if constexpr (Tombstones::tracked) {
+      PurgeTop();
+    }
+    return out;
+  }
+
+  constexpr auto ExtractMinBatch(std::span<Element> out) noexcept
+      -> std::size_t {
+    return std::distance(out.begin(),
+                         ExtractMinBatch(out.begin(), out.size()));
   }
 
   [[nodiscard]] auto ExtractMinC() noexcept
-      -> std::pair<Element, std::vector<Element>> {
-    const auto& min_tree = trees.front().min_ckey;
-    auto& x = min_tree->node_heap[0];
-    Element first_elem = x.back();
-    std::vector<Element> corrupted_elements;
-    x.pop_back();
-    if (first_elem == x.ckey) {
-      x.ckey_present = false;
-      corrupted_elements.push_back(first_elem);
-    }
-    if (2 * std::ssize(x.elements) < x.size) {
-      if (std::ssize(min_tree->node_heap) > 1) {  // Check if leaf
-        auto& min_node_heap = min_tree->node_heap;
-        const auto min_child_idx = std::ssize(min_node_heap) > 2 and
-                                           min_node_heap[1] > min_node_heap[2]
-                                       ? 2
-                                       : 1;
-        auto& min_elements = min_node_heap[min_child_idx].elements;
-        min_elements.insert(min_elements.end(),
-                            std::make_move_iterator(x.elements.begin()),
-                            std::make_move_iterator(x.elements.end()));
-        if (x.ckey_present) {
-          corrupted_elements.push_back(x.ckey);
-        }
-        std::pop_heap(min_node_heap.begin(), min_node_heap.end(),
-                      std::greater<>());
-        min_node_heap.pop_back();
-        UpdateSuffixMin(min_tree);
-      } else if (x.elements.empty()) {
-        if (min_tree != trees.begin()) {
-          const auto prev = std::prev(min_tree);
-          trees.erase(min_tree);
-          UpdateSuffixMin(prev);
-        } else {
-          trees.erase(min_tree);
-        }
+      -> std::pair<Element, std::vector<Key>> {
+    const auto min_tree = MinTree();
+    auto& nodes = min_tree->node_heap;
+    const auto root = min_tree->root();
+    auto& elements = nodes.elements(root);
+    const auto [first_elem, corrupted] = min_tree->TakeRootBack();
+    num_corrupted -= corrupted ? 1 : 0;
+    std::vector<Key> corrupted_elements;
+    counters.OnExtract();
+    if (Order::Equivalent(Order::Key(first_elem), nodes.ckey(root))) {
+      nodes.meta(root).ckey_present = false;
+      corrupted_elements.push_back(Order::Key(first_elem));
+    }
+    if (2 * std::ssize(elements) < nodes.meta(root).size) {
+      if (not min_tree->IsLeaf(root)) {
+        auto prune = Prune();
+        num_corrupted +=
+            min_tree->SiftC(corrupted_elements, counters, prune);
+        RefreshRoot(min_tree);
+      } else if (elements.empty()) {
+        EraseRoot(min_tree);
       }
     }
     --c_size;
+    if constexpr (Tombstones::tracked) {
+      handles.Release(first_elem);
+      PurgeTop();
+    }
     return std::make_pair(first_elem, corrupted_elements);
   }
 
@@ -204,13 +284,235 @@ class FlatSoftHeap {
     return trees.back().rank();
   }
 
+  // Binary-counter link: that becomes the right subtree of a new root
+  [[nodiscard]] constexpr auto Link() noexcept {
+    return [this](TreeType& tree, TreeType&& that, int rank) {
+      counters.OnCombine();
+      tree.Combine(std::forward<TreeType>(that), rank, counters);
+    };
+  }
+
+  // Restores a min root that dropped below half full: sift it from below,
+  // or drop its tree once it is an empty leaf
+  constexpr void Refill(TreeListIt min_tree) noexcept {
+    auto& nodes = min_tree->node_heap;
+    const auto root = min_tree->root();
+    auto& elements = nodes.elements(root);
+    if (2 * std::ssize(elements) < nodes.meta(root).size) {
+      if (not min_tree->IsLeaf(root)) {
+        auto prune = Prune();
+        num_corrupted += min_tree->Sift(counters, prune);
+        RefreshRoot(min_tree);
+      } else if (elements.empty()) {
+        EraseRoot(min_tree);
+      }
+    }
+  }
+
+  // After a root sift: only tombstones can have left the root empty
+  constexpr void RefreshRoot(TreeListIt tree) noexcept {
+    if (tree->node_heap.elements(tree->root()).empty()) {
+      EraseRoot(tree);
+    } else {
+      UpdateRoot(tree);
+      Compact(tree);
+    }
+  }
+
+  // Tombstone upkeep, see SoftHeap::Prune, PurgeTop and Purge
+  [[nodiscard]] constexpr auto Prune() noexcept {
+    if constexpr (Tombstones::tracked) {
+      return [this](List& elements, const Key& ckey, int& num_uncorrupted) {
+        num_dead -= EraseIf(elements, [&](const Element& element) {
+          if (not handles.Dead(element)) {
+            return false;
+          }
+          if (Order::Equivalent(Order::Key(element), ckey)) {
+            --num_uncorrupted;
+          } else {
+            --num_corrupted;
+          }
+          return true;
+        });
+      };
+    } else {
+      return policy::keep_all;
+    }
+  }
+
+  constexpr void PurgeTop() noexcept {
+    while (not trees.empty()) {
+      const auto min_tree = MinTree();
+      const auto root = min_tree->root();
+      if (not handles.Dead(min_tree->node_heap.elements(root).back())) {
+        return;
+      }
+      num_corrupted -= min_tree->TakeRootBack().second ? 1 : 0;
+      --num_dead;
+      Refill(min_tree);
+    }
+  }
+
+  // Pruning vacates leaves, so the trees it leaves sparse are compacted
+  // afterwards; relinking only ever yields dense trees.
+  constexpr void Purge() noexcept {
+    auto prune = Prune();
+    for (auto tree = trees.begin(); tree != trees.end();) {
+      const auto next = std::next(tree);
+      const auto root = tree->root();
+      tree->PruneAll(prune);
+      if (tree->node_heap.elements(root).empty() and not tree->IsLeaf(root)) {
+        num_corrupted += tree->Sift(counters, prune);
+      }
+      if (tree->node_heap.elements(root).empty()) {
+        EraseRoot(tree);
+      }
+      tree = next;
+    }
+    if (not trees.empty()) {
+      UpdateSuffixMin(std::prev(trees.end()));
+    }
+    for (auto tree = trees.begin(); tree != trees.end();) {
+      if (tree->Sparse()) {
+        Compact(tree);
+        tree = trees.begin();
+      } else {
+        ++tree;
+      }
+    }
+  }
+
+  // Meld without the counting, shared with Compact
+  constexpr void MeldTrees(FlatSoftHeap&& P) noexcept
+    requires Roots::rank_indexed
+  {
+    num_corrupted += std::exchange(P.num_corrupted, 0);
+    c_size += std::exchange(P.c_size, 0);
+    UpdateSuffixMin(trees.Merge(std::move(P.trees), Link()));
+  }
+
+  constexpr void MeldTrees(FlatSoftHeap&& P) noexcept {
+    num_corrupted += std::exchange(P.num_corrupted, 0);
+    if (trees.empty()) {  // suffix minima of P stay valid across the swap
+      trees.swap(P.trees);
+      c_size += std::exchange(P.c_size, 0);
+      return;
+    }
+    if (P.trees.empty()) {
+      return;
+    }
+    if (P.rank() > rank()) {
+      trees.swap(P.trees);
+    }
+    c_size += std::exchange(P.c_size, 0);
+    const auto p_rank = P.rank();
+    trees.merge(P.trees);
+
+    // Binary addition over the rank-sorted list, see SoftHeap::Meld
+    for (auto tree = trees.begin(); std::next(tree) != trees.end();) {
+      const auto next = std::next(tree);
+      if (tree->rank() != next->rank()) {
+        if (tree->rank() > p_rank) {
+          UpdateSuffixMin(tree);
+          return;
+        }
+        tree = next;
+      } else if (std::next(next) != trees.end() and
+                 std::next(next)->rank() == tree->rank()) {
+        tree = next;
+      } else {
+        Link()(*tree, std::move(*next), tree->rank() + 1);
+        trees.erase(next);
+      }
+    }
+    UpdateSuffixMin(std::prev(trees.end()));
+  }
+
+  // Frees the holes of a tree that sifts have left sparse: its nodes are
+  // relinked as leaves, each keeping its elements, ckey and corruption
+  // counts, and the resulting trees are melded back in. The links sift like
+  // those of an insert, and are paid for by the quarter of the tree's slots
+  // vacated since it was built.
+  constexpr void Compact(TreeListIt tree) noexcept {
+    if (not tree->Sparse()) {
+      return;
+    }
+    counters.OnCompaction();
+    auto burst = FlatSoftHeap();
+    auto forest = RankedTrees<TreeType>();
+    tree->ForEachNode([&](std::ptrdiff_t idx) {
+      forest.Carry(0, TreeType(*tree, idx), Link());
+    });
+    EraseRoot(tree);  // reads only the rank, which the moved root keeps
+    if constexpr (Roots::rank_indexed) {
+      burst.trees = std::move(forest);
+    } else {
+      for (auto& leaves : forest) {
+        burst.trees.push_back(std::move(leaves));
+      }
+    }
+    burst.UpdateSuffixMin(std::prev(burst.trees.end()));
+    MeldTrees(std::move(burst));
+  }
+
+  // Min root lookup and upkeep, see SoftHeap
+  [[nodiscard]] constexpr auto MinTree() noexcept -> TreeListIt {
+    if constexpr (scan_roots) {
+      return trees.At(root_keys.ArgMin());
+    } else {
+      return trees.front().min_ckey;
+    }
+  }
+
+  [[nodiscard]] constexpr auto MinRoot() const noexcept -> const TreeType& {
+    if constexpr (scan_roots) {
+      return *trees.At(root_keys.ArgMin());
+    } else {
+      return *trees.front().min_ckey;
+    }
+  }
+
+  constexpr void UpdateRoot(TreeListIt tree) noexcept {
+    if constexpr (scan_roots) {
+      root_keys.Set(tree->rank(), tree->RootCKey());
+    } else {
+      UpdateSuffixMin(tree);
+    }
+  }
+
+  constexpr void EraseRoot(TreeListIt tree) noexcept {
+    if constexpr (scan_roots) {
+      root_keys.Clear(tree->rank());
+      trees.erase(tree);
+    } else if (tree != trees.begin()) {
+      const auto prev = std::prev(tree);
+      trees.erase(tree);
+      UpdateSuffixMin(prev);
+    } else {
+      trees.erase(tree);
+    }
+  }
+
   constexpr void UpdateSuffixMin(TreeListIt it) noexcept {
+    counters.OnSuffixMinUpdate();
+    if constexpr (scan_roots) {
+      for (int rank = 0; rank <= it.rank() and rank < TreeList::max_rank;
+           ++rank) {
+        if (trees.Occupied(rank)) {
+          root_keys.Set(rank, trees.At(rank)->RootCKey());
+        } else {
+          root_keys.Clear(rank);
+        }
+      }
+      return;
+    }
     std::advance(it, 1);
     while (it != trees.begin()) {
       std::advance(it, -1);
       it->min_ckey =
           (std::next(it) == trees.end() or
-           std::next(it)->min_ckey->node_heap[0].ckey >= it->node_heap[0].ckey)
+           not Order::Less(std::next(it)->min_ckey->RootCKey(),
+                           it->RootCKey()))
               ? it
               : std::next(it)->min_ckey;
     }
@@ -218,10 +520,35 @@ class FlatSoftHeap {
 
   [[nodiscard]] auto size() const noexcept { return c_size; }
 
+  // O(1) count of corrupted elements, see SoftHeap
+  [[nodiscard]] constexpr auto num_corrupted_keys() const noexcept
+      -> std::size_t {
+    return num_corrupted;
+  }
+
+  // Operation counts, see SoftHeap::stats
+  [[nodiscard]] constexpr auto stats() const noexcept -> StatsSnapshot {
+    return counters.snapshot();
+  }
+
   const double epsilon;
 
  private:
   size_t c_size{};
+  std::size_t num_corrupted = 0;
+  [[no_unique_address]] Stats counters;
+  [[no_unique_address]] std::conditional_t<scan_roots, RootKeys<Key, Order>,
+                                           detail::NoRootKeys>
+      root_keys;
+  [[no_unique_address]] Tombstones handles;
+  std::size_t num_dead = 0;  // tombstones still in the lists
+
+  // Meld without its guard, see SoftHeap::Absorb
+  constexpr void Absorb(FlatSoftHeap&& P) noexcept {
+    counters.OnMeld();
+    counters.Merge(P.counters);
+    MeldTrees(std::move(P));
+  }
 };
 
 }  // namespace soft_heap
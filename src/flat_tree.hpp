@@ -1,132 +1,222 @@
 #pragma once
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <list>
 #include <memory>
 #include <set>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
-#include "flat_node.hpp"
+#include "flat_layout.hpp"
+#include "order.hpp"
 #include "policies.hpp"
+#include "ranked_trees.hpp"
+#include "stats.hpp"
+#include "tombstones.hpp"
 #include "utility.hpp"
 
 namespace soft_heap {
 
 template <policy::TotalOrdered Element, policy::TotalOrderedContainer List,
-          int inverse_epsilon>
+          int inverse_epsilon,
+          policy::RootContainer Roots = policy::LinkedRoots,
+          policy::ElementOrder<Element> Order = policy::NaturalOrder,
+          policy::FlatLayout Layout = policy::NodeArrayLayout>
 class FlatTree {
  public:
-  using TreeList = std::list<FlatTree>;
+  using TreeList = typename Roots::template Container<FlatTree>;
   using TreeListIt = typename TreeList::iterator;
+  using Nodes = typename Layout::template Storage<Element, List,
+                                                  inverse_epsilon, Order>;
+  using Key = typename Order::template KeyType<Element>;
 
-  constexpr explicit FlatTree(Element&& element) noexcept {
+  constexpr explicit FlatTree(Element&& element) noexcept
+      : occupied{Bit(0)} {
     node_heap.emplace_back(std::forward<Element>(element));
   }
 
+  // A leaf holding node idx of from, moved over with its elements, ckey and
+  // corruption counts, see ForEachNode. The slot in from is left as a hole.
+  constexpr FlatTree(FlatTree& from, std::ptrdiff_t idx) noexcept
+      : occupied{Bit(0)} {
+    node_heap.append(from.node_heap, idx, idx + 1);
+    node_heap.meta(0).rank = 0;
+    node_heap.meta(0).size = 1;
+    from.occupied[Word(idx)] &= ~Bit(idx);
+    --from.num_live;
+  }
+
+  // The tree is a perfect binary tree in post-order: each subtree is one
+  // contiguous block ending in its root, so node idx of rank h has its right
+  // child at idx - 1 and its left child at idx - 2^h.
+  [[nodiscard]] constexpr auto root() const noexcept -> std::ptrdiff_t {
+    return node_heap.ssize() - 1;
+  }
+
   [[nodiscard]] constexpr auto rank() const noexcept {
-    // return node_heap.back()->rank;
-    return static_cast<int>(std::log2(std::ssize(node_heap)));
+    return node_heap.meta(root()).rank;
   }
 
-  constexpr void Sift() noexcept {
-    constexpr auto IsLeaf = [](int idx, auto& node_heap) constexpr {
-      return std::ssize(node_heap) < 2 * idx + 2 or
-             (node_heap[2 * idx + 1].ckey == -1 and
-              (std::ssize(node_heap) < 2 * idx + 3 or
-               node_heap[2 * idx + 2].ckey == -1));
-    };
-    constexpr auto RecursiveSift = [](int idx, auto&& node_heap, auto&& self,
-                                      auto&& IsLeaf) constexpr -> void {
-      auto& elements = node_heap[idx].elements;
-
-      while (std::ssize(elements) < node_heap[idx].size and
-             not IsLeaf(idx, node_heap)) {
-        const auto left_idx = 2 * idx + 1;
-        const auto right_idx = 2 * idx + 2;
-        const auto min_child_idx =
-            (std::ssize(node_heap) < right_idx or
-             node_heap[left_idx].ckey == -1) or
-                    (std::ssize(node_heap) > right_idx and
-                     node_heap[right_idx].ckey != -1 and
-                     node_heap[left_idx] > node_heap[right_idx])
-                ? right_idx
-                : left_idx;
-        auto& min_elements = node_heap[min_child_idx].elements;
-        if (elements.empty()) {
-          elements = std::move(min_elements);
-        } else {
-          elements.insert(elements.end(),
-                          std::make_move_iterator(min_elements.begin()),
-                          std::make_move_iterator(min_elements.end()));
-        }
-        node_heap[idx].ckey = node_heap[min_child_idx].ckey;
-        if (IsLeaf(min_child_idx, node_heap)) {
-          node_heap[min_child_idx].ckey = -1;  // mark for removal
-        } else {
-          min_elements.clear();
-          self(min_child_idx, node_heap, self, IsLeaf);
-        }
+  [[nodiscard]] constexpr auto RootCKey() const noexcept -> const Key& {
+    return node_heap.ckey(root());
+  }
+
+  // Nodes removed by a sift leave a hole: its element list and ckey are
+  // dropped at once, and the slot once the tree turns Sparse and its heap
+  // relinks the rest. Holes are tracked in an occupancy bitmap, never in the
+  // ckeys, so every key value stays usable.
+  [[nodiscard]] constexpr auto Vacant(std::ptrdiff_t idx) const noexcept {
+    return (occupied[Word(idx)] & Bit(idx)) == 0;
+  }
+
+  // Whether fewer than a quarter of the slots still hold a node. Linking
+  // leaves one hole per combine, so a freshly built tree is about half full
+  // and has to lose half its nodes to get here.
+  [[nodiscard]] constexpr auto Sparse() const noexcept {
+    return 4 * num_live < node_heap.ssize();
+  }
+
+  // Runs prune over every list, children first, and vacates the leaves it
+  // empties
+  constexpr void PruneAll(auto& prune) noexcept {
+    ForEachNode([&](std::ptrdiff_t idx) {
+      prune(node_heap.elements(idx), node_heap.ckey(idx),
+            node_heap.meta(idx).num_uncorrupted);
+      if (idx != root() and IsLeaf(idx) and node_heap.elements(idx).empty()) {
+        Vacate(idx);
       }
-    };
-    RecursiveSift(0, node_heap, RecursiveSift, IsLeaf);
+    });
+  }
 
-    std::make_heap(node_heap.begin(), node_heap.end(), std::greater<>());
-    while (node_heap[0].ckey == -1) {
-      std::pop_heap(node_heap.begin(), node_heap.end(), std::greater<>());
-      node_heap.pop_back();
+  // Calls f(idx) for every occupied slot, in post-order
+  constexpr void ForEachNode(auto&& f) {
+    for (std::size_t word = 0; word < occupied.size(); ++word) {
+      for (auto bits = occupied[word]; bits != 0; bits &= bits - 1) {
+        f(static_cast<std::ptrdiff_t>(64 * word + std::countr_zero(bits)));
+      }
     }
   }
 
-  constexpr void SiftInsert() noexcept {
-    constexpr auto IsLeaf = [](int idx, auto& node_heap) constexpr {
-      return std::ssize(node_heap) < 2 * idx + 2 or
-             (node_heap[2 * idx + 1].ckey == decltype(node_heap[idx].ckey){} and
-              (std::ssize(node_heap) < 2 * idx + 3 or
-               node_heap[2 * idx + 2].ckey == decltype(node_heap[idx].ckey){}));
-    };
-    constexpr auto RecursiveSift = [](int idx, auto&& node_heap, auto&& self,
-                                      auto&& IsLeaf) constexpr -> void {
-      auto& elements = node_heap[idx].elements;
-
-      while (elements.empty() and not IsLeaf(idx, node_heap)) {
-        const auto left_idx = 2 * idx + 1;
-        const auto right_idx = 2 * idx + 2;
-        const auto min_child_idx =
-            (std::ssize(node_heap) < right_idx or
-             node_heap[left_idx].ckey == decltype(node_heap[idx].ckey){}) or
-                    (std::ssize(node_heap) > right_idx and
-                     node_heap[right_idx].ckey !=
-                         decltype(node_heap[idx].ckey){} and
-                     node_heap[left_idx] > node_heap[right_idx])
-                ? right_idx
-                : left_idx;
-        auto& min_elements = node_heap[min_child_idx].elements;
-        if (elements.empty()) {
-          elements = std::move(min_elements);
-        } else {
-          elements.insert(elements.end(),
-                          std::make_move_iterator(min_elements.begin()),
-                          std::make_move_iterator(min_elements.end()));
-        }
-        node_heap[idx].ckey = node_heap[min_child_idx].ckey;
-        if (IsLeaf(min_child_idx, node_heap)) {
-          node_heap[min_child_idx].ckey =
-              decltype(node_heap[idx].ckey){};  // mark for removal
-        } else {
-          min_elements.clear();
-          self(min_child_idx, node_heap, self, IsLeaf);
-        }
-      }
-    };
-    RecursiveSift(0, node_heap, RecursiveSift, IsLeaf);
+  [[nodiscard]] constexpr auto IsLeaf(std::ptrdiff_t idx) const noexcept {
+    return node_heap.meta(idx).rank == 0 or Children(idx) == 0;
+  }
+
+  // Links that, of the same rank, under a fresh root as its right subtree.
+  // In post-order that is our block, then that's block, then the root, so
+  // the link is two sequential block moves into an array sized for exactly
+  // 2 * count + 1 nodes, with that's occupancy words shifted in behind ours.
+  // Moving our block too keeps the cost O(count), as appending that's block
+  // already is, and leaves no tree holding spare capacity. The root then
+  // fills from below like Node's combining constructor.
+  template <policy::OperationStats Stats = const policy::NoStats>
+  constexpr void Combine(FlatTree&& that, int rank,
+                         Stats& stats = policy::no_stats) noexcept {
+    const auto count = node_heap.ssize();
+    const auto size = (rank > RankThreshold(inverse_epsilon))
+                          ? node_heap.meta(root()).size + 1
+                          : 1;
+    node_heap.reserve(2 * count + 1);
+    node_heap.append(that.node_heap, 0, count);
+    node_heap.emplace_back(rank, size);
+    occupied.resize(static_cast<std::size_t>(Word(2 * count) + 1));
+    ShiftIn(occupied, that.occupied, count);
+    occupied[Word(2 * count)] |= Bit(2 * count);
+    num_live += that.num_live + 1;
+    SiftInsert(root(), stats);
+  }
+
+  // Refills node idx from its smaller child until it holds size elements,
+  // see Node::Sift. Only the paths into the children pulled from are
+  // touched, so a root sift costs O(rank) rather than O(tree size).
+  // Returns the number of elements the sift corrupted.
+  template <policy::OperationStats Stats = const policy::NoStats,
+            class Prune = const policy::KeepAll>
+  constexpr auto Sift(std::ptrdiff_t idx, Stats& stats = policy::no_stats,
+                      Prune& prune = policy::keep_all) noexcept
+      -> std::size_t {
+    auto corrupted = std::size_t{0};
+    while (std::ssize(node_heap.elements(idx)) < node_heap.meta(idx).size and
+           not IsLeaf(idx)) {
+      corrupted += PullUp(idx, stats, prune, [&](std::ptrdiff_t child) {
+        return Sift(child, stats, prune);
+      });
+    }
+    return corrupted;
+  }
+
+  template <policy::OperationStats Stats = const policy::NoStats,
+            class Prune = const policy::KeepAll>
+  constexpr auto Sift(Stats& stats = policy::no_stats,
+                      Prune& prune = policy::keep_all) noexcept
+      -> std::size_t {
+    return Sift(root(), stats, prune);
+  }
 
-    std::make_heap(node_heap.begin(), node_heap.end(), std::greater<>());
-    while (node_heap[0].ckey == decltype(node_heap[0].ckey){}) {
-      std::pop_heap(node_heap.begin(), node_heap.end(), std::greater<>());
-      node_heap.pop_back();
+  // Fills an empty node, so nothing is corrupted on the way
+  template <policy::OperationStats Stats = const policy::NoStats>
+  constexpr void SiftInsert(std::ptrdiff_t idx,
+                            Stats& stats = policy::no_stats) noexcept {
+    while (node_heap.elements(idx).empty() and not IsLeaf(idx)) {
+      PullUp(idx, stats, policy::keep_all, [&](std::ptrdiff_t child) {
+        SiftInsert(child, stats);
+        return std::size_t{0};
+      });
     }
   }
 
+  // Sift that also reports the keys corrupted on the way, see Node::SiftC
+  template <policy::OperationStats Stats = const policy::NoStats,
+            class Prune = const policy::KeepAll>
+  constexpr auto SiftC(std::vector<Key>& corrupted_elems, std::ptrdiff_t idx,
+                       Stats& stats = policy::no_stats,
+                       Prune& prune = policy::keep_all) noexcept
+      -> std::size_t {
+    auto corrupted = std::size_t{0};
+    while (std::ssize(node_heap.elements(idx)) < node_heap.meta(idx).size and
+           not IsLeaf(idx)) {
+      if (not node_heap.elements(idx).empty() and
+          node_heap.meta(idx).ckey_present) {
+        corrupted_elems.push_back(node_heap.ckey(idx));
+      }
+      node_heap.meta(idx).ckey_present =
+          node_heap.meta(MinChild(idx)).ckey_present;
+      corrupted += PullUp(idx, stats, prune, [&](std::ptrdiff_t child) {
+        return SiftC(corrupted_elems, child, stats, prune);
+      });
+    }
+    return corrupted;
+  }
+
+  template <policy::OperationStats Stats = const policy::NoStats,
+            class Prune = const policy::KeepAll>
+  constexpr auto SiftC(std::vector<Key>& corrupted_elems,
+                       Stats& stats = policy::no_stats,
+                       Prune& prune = policy::keep_all) noexcept
+      -> std::size_t {
+    return SiftC(corrupted_elems, root(), stats, prune);
+  }
+
+  // Moves out the root's last element along with whether it was corrupted,
+  // see Node::TakeBack
+  [[nodiscard]] constexpr auto TakeRootBack() noexcept
+      -> std::pair<Element, bool> {
+    auto& elements = node_heap.elements(root());
+    const auto exact =
+        Order::Equivalent(Order::Key(elements.back()), node_heap.ckey(root()));
+    node_heap.meta(root()).num_uncorrupted -= exact ? 1 : 0;
+    auto taken =
+        std::pair<Element, bool>(std::move(elements.back()), not exact);
+    elements.pop_back();
+    return taken;
+  }
+
   constexpr auto operator<=>(const FlatTree& that) const noexcept
       -> std::strong_ordering {
     return this->rank() <=> that.rank();
@@ -146,29 +236,123 @@ class FlatTree {
     out << "Tree: " << tree.rank() << "(rank)"
         << "\nwith Nodes:\n";
 
-    auto preorder = [&](auto self, int n) -> void {
-      out << tree.node_heap[n];
-      auto left = (std::ssize(tree.node_heap) > 2 * n + 1)
-                      ? tree.node_heap[2 * n + 1].ckey
-                      : -1;
-      auto right = (std::ssize(tree.node_heap) > 2 * n + 2)
-                       ? tree.node_heap[2 * n + 2].ckey
-                       : -1;
-      out << "\nand children: " << left << ", " << right << '\n' << std::endl;
-      if (std::ssize(tree.node_heap) > 2 * n + 1) {
-        self(self, 2 * n + 1);
+    const auto& nodes = tree.node_heap;
+    auto preorder = [&](auto self, std::ptrdiff_t n) -> void {
+      out << "Node: " << nodes.ckey(n) << " (ckey), rank: "
+          << nodes.meta(n).rank << ", size: " << nodes.meta(n).size
+          << "\nwith elements: ";
+      std::copy(nodes.elements(n).begin(), nodes.elements(n).end(),
+                std::ostream_iterator<Element>(out, ", "));
+      out << "\nand children: ";
+      const auto rank = nodes.meta(n).rank;
+      const auto children = {n - (std::ptrdiff_t{1} << rank), n - 1};
+      for (const auto child : children) {
+        if (rank != 0 and not tree.Vacant(child)) {
+          out << nodes.ckey(child) << ' ';
+        } else {
+          out << "- ";
+        }
       }
-      if (std::ssize(tree.node_heap) > 2 * n + 2) {
-        self(self, 2 * n + 2);
+      out << '\n' << std::endl;
+      for (const auto child : children) {
+        if (rank != 0 and not tree.Vacant(child)) {
+          self(self, child);
+        }
       }
     };
-    preorder(preorder, 0);
+    preorder(preorder, tree.root());
     out << std::endl;
     return out;
   }
 
-  std::vector<FlatNode<Element, List, inverse_epsilon>> node_heap;
+  Nodes node_heap;
   TreeListIt min_ckey;
+
+ private:
+  [[nodiscard]] static constexpr auto Word(std::ptrdiff_t bit) noexcept {
+    return bit / 64;
+  }
+
+  [[nodiscard]] static constexpr auto Bit(std::ptrdiff_t bit) noexcept {
+    return std::uint64_t{1} << (bit % 64);
+  }
+
+  [[nodiscard]] constexpr auto Left(std::ptrdiff_t idx) const noexcept {
+    return idx - (std::ptrdiff_t{1} << node_heap.meta(idx).rank);
+  }
+
+  // Occupancy of the children of idx: bit 0 left, bit 1 right
+  [[nodiscard]] constexpr auto Children(std::ptrdiff_t idx) const noexcept
+      -> unsigned {
+    return (Vacant(Left(idx)) ? 0U : 0b01U) | (Vacant(idx - 1) ? 0U : 0b10U);
+  }
+
+  // Requires a non-leaf idx. A lone child is found by its bit, only two
+  // occupied children need their ckeys compared.
+  [[nodiscard]] constexpr auto MinChild(std::ptrdiff_t idx) const noexcept
+      -> std::ptrdiff_t {
+    const auto children = Children(idx);
+    const auto left = Left(idx);
+    const auto right = idx - 1;
+    if (std::popcount(children) == 1) {
+      return children == 0b01U ? left : right;
+    }
+    return Order::Less(node_heap.ckey(right), node_heap.ckey(left)) ? right
+                                                                     : left;
+  }
+
+  // ORs the bits of from into into, starting at bit offset
+  static constexpr void ShiftIn(std::vector<std::uint64_t>& into,
+                                const std::vector<std::uint64_t>& from,
+                                std::ptrdiff_t offset) noexcept {
+    const auto shift = offset % 64;
+    auto word = std::next(into.begin(), Word(offset));
+    for (const auto bits : from) {
+      *word++ |= bits << shift;
+      if (shift != 0 and (bits >> (64 - shift)) != 0) {
+        *word |= bits >> (64 - shift);
+      }
+    }
+  }
+
+  // Moves the smaller child's elements and ckey into node idx, less the
+  // tombstones prune drops. A leaf child is vacated, anything else is
+  // emptied and refilled by sift(child). If the ckey of idx rises, its
+  // elements that matched the old one are corrupted; returns how many were,
+  // plus whatever sift(child) corrupted.
+  constexpr auto PullUp(std::ptrdiff_t idx, auto& stats, auto& prune,
+                        auto&& sift) noexcept -> std::size_t {
+    const auto child = MinChild(idx);
+    prune(node_heap.elements(child), node_heap.ckey(child),
+          node_heap.meta(child).num_uncorrupted);
+    stats.OnSift(std::size(node_heap.elements(child)));
+    auto& uncorrupted = node_heap.meta(idx).num_uncorrupted;
+    const auto kept =
+        uncorrupted != 0 and
+        not Order::Less(node_heap.ckey(idx), node_heap.ckey(child));
+    auto corrupted = static_cast<std::size_t>(kept ? 0 : uncorrupted);
+    uncorrupted = (kept ? uncorrupted : 0) +
+                  std::exchange(node_heap.meta(child).num_uncorrupted, 0);
+    Concat(node_heap.elements(idx), node_heap.elements(child));
+    node_heap.set_ckey(idx, node_heap.ckey(child));
+    if (IsLeaf(child)) {
+      stats.OnLeafDeletion();
+      Vacate(child);
+    } else {
+      node_heap.elements(child).clear();
+      corrupted += sift(child);
+    }
+    return corrupted;
+  }
+
+  constexpr void Vacate(std::ptrdiff_t idx) noexcept {
+    node_heap.vacate(idx);
+    occupied[Word(idx)] &= ~Bit(idx);
+    --num_live;
+  }
+
+  std::vector<std::uint64_t> occupied;
+  std::ptrdiff_t num_live = 1;  // occupied slots
 };
 
-}  // namespace soft_heap
\ No newline at end of file
+}  // namespace soft_heap
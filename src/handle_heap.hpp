@@ -0,0 +1,42 @@
+#pragma once
+#include "flat_soft_heap.hpp"
+#include "inline_list.hpp"
+#include "order.hpp"
+#include "policies.hpp"
+#include "soft_heap.hpp"
+#include "tombstones.hpp"
+
+namespace soft_heap {
+
+namespace detail {
+
+// Orders Tagged entries by their element alone
+struct Untag {
+  template <class Element>
+  [[nodiscard]] constexpr auto operator()(
+      const Tagged<Element>& entry) const noexcept -> const Element& {
+    return entry.element;
+  }
+};
+
+}  // namespace detail
+
+// Soft heaps whose Insert returns a Handle for Delete and DecreaseKey, see
+// policy::GenerationTombstones. They hold Tagged entries: Top and
+// ExtractMin yield the entry, whose element is the one inserted.
+template <policy::TotalOrdered Element, int inverse_epsilon = 8>
+using HandleSoftHeap =
+    SoftHeap<Tagged<Element>, InlineList<Tagged<Element>>, inverse_epsilon,
+             policy::HeapAllocation, policy::LinkedRoots,
+             policy::KeyOrder<detail::Untag>, policy::AutoMinRoots,
+             policy::NoStats, policy::GenerationTombstones>;
+
+template <policy::TotalOrdered Element, int inverse_epsilon = 8>
+using HandleFlatSoftHeap =
+    FlatSoftHeap<Tagged<Element>, InlineList<Tagged<Element>>,
+                 inverse_epsilon, policy::LinkedRoots,
+                 policy::KeyOrder<detail::Untag>, policy::NodeArrayLayout,
+                 policy::AutoMinRoots, policy::NoStats,
+                 policy::GenerationTombstones>;
+
+}  // namespace soft_heap
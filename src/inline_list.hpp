@@ -0,0 +1,251 @@
+#pragma once
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "policies.hpp"
+
+namespace soft_heap {
+
+// Element list that keeps up to inline_capacity elements inside the node and
+// only spills to a heap buffer, vector-style, once it grows past that. Below
+// the rank threshold every node targets a single element, so nearly all
+// element lists of a soft heap never allocate. Iterators are plain pointers
+// into whichever buffer is live. Only the paths that may spill allocate, and
+// only they can throw.
+template <class T, std::size_t inline_capacity = 2>
+class InlineList {
+  static_assert(inline_capacity > 0);
+
+ public:
+  using value_type = T;
+  using reference = T&;
+  using const_reference = const T&;
+  using iterator = T*;
+  using const_iterator = const T*;
+  using difference_type = std::ptrdiff_t;
+  using size_type = std::size_t;
+
+  InlineList() noexcept = default;
+
+  InlineList(std::initializer_list<T> init) {
+    reserve(init.size());
+    for (const auto& x : init) {
+      push_back(x);
+    }
+  }
+
+  InlineList(const InlineList& that) {
+    reserve(that.count);
+    std::uninitialized_copy_n(that.first, that.count, first);
+    count = that.count;
+  }
+
+  InlineList(InlineList&& that) noexcept { Take(that); }
+
+  auto operator=(const InlineList& that) -> InlineList& {
+    if (&that != this) {
+      clear();
+      reserve(that.count);
+      std::uninitialized_copy_n(that.first, that.count, first);
+      count = that.count;
+    }
+    return *this;
+  }
+
+  auto operator=(InlineList&& that) noexcept -> InlineList& {
+    if (&that != this) {
+      clear();
+      Release();
+      Take(that);
+    }
+    return *this;
+  }
+
+  ~InlineList() {
+    clear();
+    Release();
+  }
+
+  [[nodiscard]] auto begin() noexcept -> iterator { return first; }
+  [[nodiscard]] auto begin() const noexcept -> const_iterator { return first; }
+  [[nodiscard]] auto cbegin() const noexcept -> const_iterator {
+    return first;
+  }
+  [[nodiscard]] auto end() noexcept -> iterator { return first + count; }
+  [[nodiscard]] auto end() const noexcept -> const_iterator {
+    return first + count;
+  }
+  [[nodiscard]] auto cend() const noexcept -> const_iterator {
+    return first + count;
+  }
+
+  [[nodiscard]] auto size() const noexcept -> size_type { return count; }
+
+  [[nodiscard]] auto max_size() const noexcept -> size_type {
+    return std::numeric_limits<difference_type>::max();
+  }
+
+  [[nodiscard]] auto capacity() const noexcept -> size_type { return room; }
+
+  [[nodiscard]] auto empty() const noexcept { return count == 0; }
+
+  // Whether the elements still live in the inline buffer
+  [[nodiscard]] auto is_inline() const noexcept {
+    return first == Inline();
+  }
+
+  [[nodiscard]] auto back() noexcept -> reference { return first[count - 1]; }
+
+  [[nodiscard]] auto back() const noexcept -> const_reference {
+    return first[count - 1];
+  }
+
+  void reserve(size_type n) {
+    if (n > room) {
+      Grow(n);
+    }
+  }
+
+  // args may refer into the list, e.g. emplace_back(back()): when the list
+  // is full the new element is built in the new buffer before the old
+  // elements move over, as std::vector does
+  template <class... Args>
+  auto emplace_back(Args&&... args) -> reference {
+    if (count == room) {
+      auto* const spilled = std::allocator<T>().allocate(2 * room);
+      try {
+        ::new (spilled + count) T(std::forward<Args>(args)...);
+      } catch (...) {
+        std::allocator<T>().deallocate(spilled, 2 * room);
+        throw;
+      }
+      Relocate(spilled, 2 * room);
+    } else {
+      ::new (first + count) T(std::forward<Args>(args)...);
+    }
+    return first[count++];
+  }
+
+  void push_back(const T& elem) { emplace_back(elem); }
+  void push_back(T&& elem) { emplace_back(std::move(elem)); }
+
+  void pop_back() noexcept { std::destroy_at(first + --count); }
+
+  // Keeps the buffer, like std::vector::clear
+  void clear() noexcept {
+    std::destroy_n(first, count);
+    count = 0;
+  }
+
+  // [from, last) may be a range of this list: a forward range that does not
+  // fit is copied into the new buffer while the old one is still alive, and
+  // appending in place never moves the elements it reads
+  template <std::input_iterator It>
+  auto insert(const_iterator pos, It from, It last) -> iterator {
+    const auto offset = pos - first;
+    const auto old_count = count;
+    if constexpr (std::forward_iterator<It>) {
+      const auto n = static_cast<size_type>(std::distance(from, last));
+      if (count + n > room) {
+        const auto new_room = std::max(count + n, 2 * room);
+        auto* const spilled = std::allocator<T>().allocate(new_room);
+        try {
+          std::uninitialized_copy(from, last, spilled + count);
+        } catch (...) {
+          std::allocator<T>().deallocate(spilled, new_room);
+          throw;
+        }
+        Relocate(spilled, new_room);
+        count += n;
+        std::rotate(first + offset, first + old_count, first + count);
+        return first + offset;
+      }
+    }
+    for (; from != last; ++from) {
+      emplace_back(*from);
+    }
+    std::rotate(first + offset, first + old_count, first + count);
+    return first + offset;
+  }
+
+  void swap(InlineList& that) noexcept {
+    auto tmp = std::move(that);
+    that = std::move(*this);
+    *this = std::move(tmp);
+  }
+
+  friend void swap(InlineList& x, InlineList& y) noexcept { x.swap(y); }
+
+  [[nodiscard]] friend auto operator==(const InlineList& x,
+                                       const InlineList& y) noexcept -> bool {
+    return std::equal(x.begin(), x.end(), y.begin(), y.end());
+  }
+
+  [[nodiscard]] friend auto operator<=>(const InlineList& x,
+                                        const InlineList& y) noexcept {
+    return std::lexicographical_compare_three_way(x.begin(), x.end(),
+                                                  y.begin(), y.end());
+  }
+
+ private:
+  [[nodiscard]] auto Inline() noexcept -> T* {
+    return std::launder(reinterpret_cast<T*>(storage));
+  }
+
+  [[nodiscard]] auto Inline() const noexcept -> const T* {
+    return std::launder(reinterpret_cast<const T*>(storage));
+  }
+
+  // Moves the elements into a heap buffer with room for n
+  void Grow(size_type n) {
+    Relocate(std::allocator<T>().allocate(n), n);
+  }
+
+  // Moves the elements to the front of spilled, a fresh buffer with room
+  // for n, and frees the old one
+  void Relocate(T* spilled, size_type n) {
+    std::uninitialized_move_n(first, count, spilled);
+    std::destroy_n(first, count);
+    Release();
+    first = spilled;
+    room = n;
+  }
+
+  // Frees a spilled buffer; the list must already be empty
+  void Release() noexcept {
+    if (not is_inline()) {
+      std::allocator<T>().deallocate(first, room);
+      first = Inline();
+      room = inline_capacity;
+    }
+  }
+
+  // Steals a spilled buffer, or moves inline elements one by one; that is
+  // left empty and inline
+  void Take(InlineList& that) noexcept {
+    if (that.is_inline()) {
+      std::uninitialized_move_n(that.first, that.count, first);
+      count = that.count;
+      that.clear();
+    } else {
+      first = std::exchange(that.first, that.Inline());
+      room = std::exchange(that.room, inline_capacity);
+      count = std::exchange(that.count, 0);
+    }
+  }
+
+  T* first = Inline();
+  size_type count = 0;
+  size_type room = inline_capacity;
+  alignas(T) std::byte storage[sizeof(T) * inline_capacity];
+};
+static_assert(policy::TotalOrderedContainer<InlineList<int>>);
+
+}  // namespace soft_heap
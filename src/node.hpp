@@ -2,119 +2,152 @@
 #include <algorithm>
 #include <cmath>
 #include <compare>
+#include <cstddef>
+#include <initializer_list>
 #include <iostream>
 #include <iterator>
 #include <list>
 #include <memory>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "node_pool.hpp"
+#include "order.hpp"
 #include "policies.hpp"
+#include "stats.hpp"
+#include "tombstones.hpp"
 #include "utility.hpp"
 
 namespace soft_heap {
 
 template <policy::TotalOrdered Element, policy::TotalOrderedContainer List,
-          int inverse_epsilon>
+          int inverse_epsilon,
+          policy::NodeAllocation Allocation = policy::HeapAllocation,
+          policy::ElementOrder<Element> Order = policy::NaturalOrder>
 class Node {
  public:
-  using NodePtr = std::unique_ptr<Node>;
+  using NodePtr =
+      std::unique_ptr<Node, typename Allocation::template Deleter<Node>>;
+  using Key = typename Order::template KeyType<Element>;
 
   Node() = delete;
 
   constexpr explicit Node(Element&& element) noexcept
       : elements(List{std::forward<Element>(element)}),
-        ckey(std::forward<Element>(element)),
+        ckey(Order::Key(*elements.begin())),
         rank(0),
         size(1),
         left(nullptr),
         right(nullptr),
-        ckey_present(true) {}
+        ckey_present(true),
+        num_uncorrupted(1) {}
 
   constexpr explicit Node(int rank, int size, List&& list) noexcept
       : elements(std::move(list)),
-        ckey(*std::max_element(elements.begin(), elements.end())),
+        ckey(Order::Key(*std::max_element(
+            elements.begin(), elements.end(),
+            [](const auto& x, const auto& y) {
+              return Order::Less(Order::Key(x), Order::Key(y));
+            }))),
         rank(rank),
         size(size),
         left(nullptr),
         right(nullptr),
-        ckey_present(true) {}
-
-  constexpr explicit Node(NodePtr&& node1, NodePtr&& node2) noexcept
+        ckey_present(true),
+        num_uncorrupted(static_cast<int>(
+            std::count_if(elements.begin(), elements.end(), [&](auto&& x) {
+              return Order::Equivalent(Order::Key(x), ckey);
+            }))) {}
+
+  // Links two trees of one rank under a new root and fills it from below,
+  // reporting the sift to stats
+  template <policy::OperationStats Stats = const policy::NoStats>
+  constexpr explicit Node(NodePtr&& node1, NodePtr&& node2,
+                          Stats& stats = policy::no_stats) noexcept
       : rank((node1 == nullptr) ? node2->rank + 1 : node1->rank + 1),
         size((rank > ConstCeil(std::log2(inverse_epsilon)) + 5)
                  ? (node1 == nullptr) ? node2->size + 1 : node1->size + 1
                  : 1),
         left(std::move(node1)),
         right(std::move(node2)),
-        ckey_present(true) {
+        ckey_present(true),
+        num_uncorrupted(0) {
     // TODO remove sift call
-    Sift_Insert();
+    Sift_Insert(stats);
   }
 
   [[nodiscard]] constexpr auto IsLeaf() const noexcept {
     return left == nullptr and right == nullptr;
   };
 
-  constexpr void Sift() noexcept {
+  // Each pull from a child is one sift for stats, see policy::CountingStats.
+  // prune drops the tombstones from each list before it is pulled up.
+  // Returns the number of elements the sift corrupted.
+  template <policy::OperationStats Stats = const policy::NoStats,
+            class Prune = const policy::KeepAll>
+  constexpr auto Sift(Stats& stats = policy::no_stats,
+                      Prune& prune = policy::keep_all) noexcept
+      -> std::size_t {
+    auto corrupted = std::size_t{0};
     while (std::ssize(elements) < size and not IsLeaf()) {
       auto& min_child =
           (left == nullptr or (right != nullptr and *left > *right)) ? right
                                                                      : left;
       auto& min_element = min_child->elements;
-      if (elements.empty()) {
-        elements = std::move(min_element);
-      } else {
-        elements.insert(elements.end(),
-                        std::make_move_iterator(min_element.begin()),
-                        std::make_move_iterator(min_element.end()));
-      }
+      prune(min_element, min_child->ckey, min_child->num_uncorrupted);
+      stats.OnSift(std::size(min_element));
+      corrupted += RaiseCKey(*min_child);
+      Concat(elements, min_element);
       ckey = min_child->ckey;
       if (min_child->IsLeaf()) {
+        stats.OnLeafDeletion();
         min_child.reset();  // deallocate child
       } else {
         min_element.clear();
-        min_child->Sift();
+        corrupted += min_child->Sift(stats, prune);
       }
     }
+    return corrupted;
   }
 
-  constexpr void Sift_Insert() noexcept {
+  // Fills an empty node, so nothing is corrupted on the way
+  template <policy::OperationStats Stats = const policy::NoStats>
+  constexpr void Sift_Insert(Stats& stats = policy::no_stats) noexcept {
     while (std::ssize(elements) == 0 and not IsLeaf()) {
       auto& min_child =
           (left == nullptr or (right != nullptr and *left > *right)) ? right
                                                                      : left;
       auto& min_element = min_child->elements;
-      if (elements.empty()) {
-        elements = std::move(min_element);
-      } else {
-        elements.insert(elements.end(),
-                        std::make_move_iterator(min_element.begin()),
-                        std::make_move_iterator(min_element.end()));
-      }
+      stats.OnSift(std::size(min_element));
+      RaiseCKey(*min_child);
+      Concat(elements, min_element);
       ckey = min_child->ckey;
       if (min_child->IsLeaf()) {
+        stats.OnLeafDeletion();
         min_child.reset();  // deallocate child
       } else {
         min_element.clear();
-        min_child->Sift_Insert();
+        min_child->Sift_Insert(stats);
       }
     }
   }
 
   // TODO return list of corrupted elements
-  constexpr void SiftC(std::vector<Element>& corrupted_elems) noexcept {
+  template <policy::OperationStats Stats = const policy::NoStats,
+            class Prune = const policy::KeepAll>
+  constexpr auto SiftC(std::vector<Key>& corrupted_elems,
+                       Stats& stats = policy::no_stats,
+                       Prune& prune = policy::keep_all) noexcept
+      -> std::size_t {
+    auto corrupted = std::size_t{0};
     while (std::ssize(elements) < size and not IsLeaf()) {
       auto& min_child =
           (left == nullptr or (right != nullptr and *left > *right)) ? right
                                                                      : left;
       auto& min_element = min_child->elements;
-      if (elements.empty()) {
-        elements = std::move(min_element);
-      } else {
-        elements.insert(elements.end(),
-                        std::make_move_iterator(min_element.begin()),
-                        std::make_move_iterator(min_element.end()));
+      prune(min_element, min_child->ckey, min_child->num_uncorrupted);
+      if (not elements.empty()) {
         // If the ckey is still present as a key in elements, it will become
         // corrupted when sifting up from the min_child
         if (ckey_present) {
@@ -139,15 +172,20 @@ class Node {
         //      add ckey to corrupted list
         //    current_node->ckey_present = child->ckey_present
       }
+      stats.OnSift(std::size(min_element));
+      corrupted += RaiseCKey(*min_child);
+      Concat(elements, min_element);
       ckey = min_child->ckey;
       ckey_present = min_child->ckey_present;
       if (min_child->IsLeaf()) {
+        stats.OnLeafDeletion();
         min_child.reset();  // deallocate child
       } else {
         min_element.clear();
-        min_child->SiftC(corrupted_elems);
+        corrupted += min_child->SiftC(corrupted_elems, stats, prune);
       }
     }
+    return corrupted;
   }
 
   // std::swap(left, right);
@@ -162,13 +200,39 @@ class Node {
   //                 std::make_move_iterator(min_child->elements.end()));
   // elements.reserve(elements.size() + min_child->elements.size());
 
+  // Runs prune over every list in the subtree, children first, and frees
+  // the leaves it empties
+  constexpr void PruneAll(auto& prune) noexcept {
+    for (auto* child : {&left, &right}) {
+      if (*child == nullptr) {
+        continue;
+      }
+      (*child)->PruneAll(prune);
+      if ((*child)->IsLeaf() and (*child)->elements.empty()) {
+        child->reset();
+      }
+    }
+    prune(elements, ckey, num_uncorrupted);
+  }
+
   [[nodiscard]] constexpr auto back() const noexcept { return elements.back(); }
 
-  constexpr void pop_back() noexcept { elements.pop_back(); }
+  constexpr void pop_back() noexcept { (void)TakeBack(); }
+
+  // Moves out the last element along with whether it was corrupted
+  [[nodiscard]] constexpr auto TakeBack() noexcept
+      -> std::pair<Element, bool> {
+    const auto exact = Order::Equivalent(Order::Key(elements.back()), ckey);
+    num_uncorrupted -= exact ? 1 : 0;
+    auto taken =
+        std::pair<Element, bool>(std::move(elements.back()), not exact);
+    elements.pop_back();
+    return taken;
+  }
 
   constexpr auto operator<=>(const Node& that) const noexcept
-      -> std::strong_ordering {
-    return this->ckey <=> that.ckey;
+      -> std::weak_ordering {
+    return Order::Order(ckey, that.ckey);
   }
 
   // constexpr auto operator<=>(Node&& that) const noexcept
@@ -193,16 +257,32 @@ class Node {
 
   constexpr auto num_corrupted_keys() noexcept {
     return std::count_if(elements.begin(), elements.end(),
-                         [&](auto&& x) { return x < ckey; });
+                         [&](auto&& x) {
+                           return Order::Less(Order::Key(x), ckey);
+                         });
   }
 
   List elements;
-  Element ckey;
+  Key ckey;
   const int rank;
   const int size;
   NodePtr left;
   NodePtr right;
   bool ckey_present;
+  int num_uncorrupted;  // elements whose key still equals ckey
+
+ private:
+  // Accounts for taking over child's elements and ckey: if the ckey rises,
+  // the elements that matched the old one become corrupted. Returns how
+  // many did. The ckey of a node without such elements is never read.
+  constexpr auto RaiseCKey(Node& child) noexcept -> std::size_t {
+    const auto kept =
+        num_uncorrupted != 0 and not Order::Less(ckey, child.ckey);
+    const auto corrupted = kept ? 0 : num_uncorrupted;
+    num_uncorrupted = (kept ? num_uncorrupted : 0) +
+                      std::exchange(child.num_uncorrupted, 0);
+    return static_cast<std::size_t>(corrupted);
+  }
 };
 
 }  // namespace soft_heap
@@ -0,0 +1,254 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace soft_heap {
+
+template <class T, std::size_t slab_size>
+class NodePool;
+
+template <class T, std::size_t slab_size>
+struct NodePoolDeleter {
+  constexpr void operator()(T* node) const noexcept { pool->Release(node); }
+
+  NodePool<T, slab_size>* pool = nullptr;
+};
+
+// Slab allocator for nodes of a single heap. Nodes are carved out of
+// fixed-size slabs and recycled through an intrusive free list, so steady
+// state Insert/ExtractMin traffic never reaches the global allocator. Only
+// Make and Reserve may allocate a slab, and only they can throw.
+template <class T, std::size_t slab_size>
+class NodePool {
+ public:
+  using Deleter = NodePoolDeleter<T, slab_size>;
+  using Ptr = std::unique_ptr<T, Deleter>;
+
+  NodePool() = default;
+  NodePool(const NodePool&) = delete;
+  NodePool(NodePool&&) = delete;
+  auto operator=(const NodePool&) -> NodePool& = delete;
+  auto operator=(NodePool&&) -> NodePool& = delete;
+  ~NodePool() = default;
+
+  template <class... Args>
+  [[nodiscard]] auto Make(Args&&... args) -> Ptr {
+    auto* node = ::new (Acquire()) T(std::forward<Args>(args)...);
+    ++num_live;
+    return Ptr(node, Deleter{this});
+  }
+
+  // Into this pool's free list, or the one it forwards to
+  void Release(T* node) noexcept {
+    std::destroy_at(node);
+    auto* slot = std::launder(reinterpret_cast<Slot*>(node));
+    --num_live;
+    auto& owner = target != nullptr ? *target : *this;
+    if (&owner != this) {
+      --owner.num_live;
+    }
+    owner.PushFree(slot);
+  }
+
+  // Hands every slab and free slot over to `to`, which counts this pool's
+  // live nodes as its own from then on. Those nodes still name this pool in
+  // their deleters, so it stays behind as a forwarding stub: its releases go
+  // to `to`, and live() counts only the nodes still pointing here. A stub is
+  // just moved on to the new owner, along with its count, so it must be
+  // moved before the pool it forwarded to.
+  void ForwardTo(NodePool& to) noexcept {
+    if (target != nullptr) {
+      target->num_live -= num_live;
+      to.num_live += num_live;
+      target = &to;
+      return;
+    }
+    if (not slabs.empty()) {
+      ThreadFreeList(slabs.back().get() + slab_used,
+                     slabs.back().get() + slab_size);
+      slab_used = slab_size;
+    }
+    if (free_list != nullptr) {
+      free_tail->next = to.free_list;
+      if (to.free_list == nullptr) {
+        to.free_tail = free_tail;
+      }
+      to.free_list = std::exchange(free_list, nullptr);
+    }
+    // ahead of the slab `to` is still carving nodes from
+    to.slabs.insert(to.slabs.begin(), std::make_move_iterator(slabs.begin()),
+                    std::make_move_iterator(slabs.end()));
+    slabs.clear();
+    to.num_live += num_live;
+    target = &to;
+  }
+
+  // Makes room for `count` more nodes without further slab allocation
+  void Reserve(std::ptrdiff_t count) {
+    if (capacity() - num_live >= count) {
+      return;
+    }
+    if (not slabs.empty()) {  // hand the rest of the current slab out first
+      ThreadFreeList(slabs.back().get() + slab_used,
+                     slabs.back().get() + slab_size);
+      slab_used = slab_size;
+    }
+    while (capacity() - num_live < count) {
+      slabs.push_back(std::make_unique_for_overwrite<Slot[]>(slab_size));
+      ThreadFreeList(slabs.back().get(), slabs.back().get() + slab_size);
+    }
+  }
+
+  [[nodiscard]] auto capacity() const noexcept {
+    return std::ssize(slabs) * static_cast<std::ptrdiff_t>(slab_size);
+  }
+
+  [[nodiscard]] auto live() const noexcept { return num_live; }
+
+ private:
+  union Slot {
+    Slot* next;
+    alignas(T) std::byte storage[sizeof(T)];
+  };
+
+  void PushFree(Slot* slot) noexcept {
+    if (free_list == nullptr) {
+      free_tail = slot;
+    }
+    slot->next = free_list;
+    free_list = slot;
+  }
+
+  [[nodiscard]] auto Acquire() -> void* {
+    if (free_list != nullptr) {
+      auto* slot = free_list;
+      free_list = slot->next;
+      return slot->storage;
+    }
+    if (slab_used == slab_size) {
+      slabs.push_back(std::make_unique_for_overwrite<Slot[]>(slab_size));
+      slab_used = 0;
+    }
+    return slabs.back()[slab_used++].storage;
+  }
+
+  void ThreadFreeList(Slot* first, Slot* last) noexcept {
+    while (last != first) {
+      PushFree(--last);
+    }
+  }
+
+  std::vector<std::unique_ptr<Slot[]>> slabs;
+  Slot* free_list = nullptr;
+  Slot* free_tail = nullptr;  // valid while free_list is not null
+  std::size_t slab_used = slab_size;
+  std::ptrdiff_t num_live = 0;
+  NodePool* target = nullptr;  // set once this is a forwarding stub
+};
+
+namespace policy {
+
+// Default: every node is its own std::make_unique allocation.
+struct HeapAllocation {
+  template <class Node>
+  using Deleter = std::default_delete<Node>;
+
+  template <class Node>
+  struct Resource {
+    template <class... Args>
+    [[nodiscard]] constexpr auto Make(Args&&... args) const {
+      return std::make_unique<Node>(std::forward<Args>(args)...);
+    }
+
+    constexpr void Adopt(Resource&& /*that*/) noexcept {}
+
+    constexpr void Reserve(std::ptrdiff_t /*count*/) const noexcept {}
+  };
+};
+
+// Nodes come from a NodePool owned by the heap instance.
+template <std::size_t slab_size = 256>
+struct PoolAllocation {
+  template <class Node>
+  using Deleter = NodePoolDeleter<Node, slab_size>;
+
+  template <class Node>
+  class Resource {
+   public:
+    using Pool = NodePool<Node, slab_size>;
+
+    Resource() noexcept = default;
+    Resource(const Resource&) = delete;
+    auto operator=(const Resource&) -> Resource& = delete;
+    ~Resource() = default;
+
+    // Leaves that without a pool, which reads as an empty one until its
+    // next Make or Reserve
+    Resource(Resource&& that) noexcept
+        : pool(std::move(that.pool)), adopted(std::exchange(that.adopted, {})) {}
+
+    // Swaps rather than frees, so the nodes of the heap assigned over can
+    // still be released into their pools by whoever holds them now
+    auto operator=(Resource&& that) noexcept -> Resource& {
+      pool.swap(that.pool);
+      adopted.swap(that.adopted);
+      return *this;
+    }
+
+    // Also drops the newest adopted stubs once their nodes are all gone;
+    // Adopt sweeps up any drained out of order
+    template <class... Args>
+    [[nodiscard]] auto Make(Args&&... args) {
+      while (not adopted.empty() and adopted.back()->live() == 0) {
+        adopted.pop_back();
+      }
+      return Own().Make(std::forward<Args>(args)...);
+    }
+
+    // Takes over the memory of a heap melded into this one. Its pools turn
+    // into stubs forwarding to ours, kept only while nodes handed over by
+    // Meld still point at them; a donor without live nodes is left as is.
+    void Adopt(Resource&& that) noexcept {
+      std::erase_if(adopted, [](const auto& x) { return x->live() == 0; });
+      if (that.live() == 0) {
+        return;
+      }
+      for (auto& x : that.adopted) {
+        if (x->live() != 0) {
+          x->ForwardTo(Own());
+          adopted.push_back(std::move(x));
+        }
+      }
+      that.adopted.clear();
+      that.pool->ForwardTo(Own());
+      adopted.push_back(std::move(that.pool));
+    }
+
+    void Reserve(std::ptrdiff_t count) { Own().Reserve(count); }
+
+    // Every live node of this heap, whichever pool it names
+    [[nodiscard]] auto live() const noexcept {
+      return pool != nullptr ? pool->live() : 0;
+    }
+
+    std::unique_ptr<Pool> pool;  // made on first use
+    std::vector<std::unique_ptr<Pool>> adopted;
+
+   private:
+    [[nodiscard]] auto Own() -> Pool& {
+      if (pool == nullptr) {
+        pool = std::make_unique<Pool>();
+      }
+      return *pool;
+    }
+  };
+};
+
+}  // namespace policy
+
+}  // namespace soft_heap
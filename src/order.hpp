@@ -0,0 +1,64 @@
+#pragma once
+#include <concepts>
+#include <functional>
+#include <type_traits>
+
+namespace soft_heap {
+
+namespace policy {
+
+// Orders elements by Compare over the key that Project extracts. Nodes keep
+// only the key as their ckey; the full elements stay in the element lists.
+// Both function objects must be stateless.
+template <class Project = std::identity, class Compare = std::less<>>
+struct KeyOrder {
+  using CompareType = Compare;
+
+  template <class Element>
+  using KeyType =
+      std::remove_cvref_t<std::invoke_result_t<Project, const Element&>>;
+
+  [[nodiscard]] static constexpr decltype(auto) Key(
+      const auto& element) noexcept {
+    return std::invoke(Project{}, element);
+  }
+
+  [[nodiscard]] static constexpr auto Less(const auto& x,
+                                           const auto& y) noexcept -> bool {
+    return Compare{}(x, y);
+  }
+
+  [[nodiscard]] static constexpr auto Equivalent(const auto& x,
+                                                 const auto& y) noexcept
+      -> bool {
+    return not Less(x, y) and not Less(y, x);
+  }
+
+  // Three-way comparison for node ckeys built on Less
+  [[nodiscard]] static constexpr auto Order(const auto& x,
+                                            const auto& y) noexcept
+      -> std::weak_ordering {
+    return Less(x, y)   ? std::weak_ordering::less
+           : Less(y, x) ? std::weak_ordering::greater
+                        : std::weak_ordering::equivalent;
+  }
+};
+
+// Default: the elements themselves under operator<
+using NaturalOrder = KeyOrder<>;
+
+// Max-heap: ExtractMin yields the largest key first
+template <class Project = std::identity>
+using ReverseOrder = KeyOrder<Project, std::greater<>>;
+
+template <class O, class Element>
+concept ElementOrder = requires(const Element& element) {
+  typename O::template KeyType<Element>;
+  {
+    O::Less(O::Key(element), O::Key(element))
+  } -> std::convertible_to<bool>;
+};
+
+}  // namespace policy
+
+}  // namespace soft_heap
@@ -0,0 +1,72 @@
+#pragma once
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace soft_heap {
+
+// SoftHeap, FlatSoftHeap and anything else with a bulk-building constructor
+// and a destructive Meld
+template <class Heap, class It>
+concept BulkMeldable =
+    std::move_constructible<Heap> and std::constructible_from<Heap, It, It> and
+    requires(Heap heap, Heap&& that) { heap.Meld(std::move(that)); };
+
+// Slices shorter than this are not worth a thread of their own
+inline constexpr std::size_t parallel_build_grain = std::size_t{1} << 14;
+
+// Bulk-builds [first, last) on up to num_threads threads. Every thread builds
+// a sub-heap from its own contiguous slice, then the sub-heaps are melded
+// pairwise in a tree reduction of ceil(log2(threads)) rounds, the melds of a
+// round running in parallel. The result holds the same elements as
+// Heap(first, last) but not necessarily the same trees, so which keys end up
+// corrupted may differ; the epsilon bound holds either way.
+template <class Heap, std::random_access_iterator It>
+  requires BulkMeldable<Heap, It>
+[[nodiscard]] auto ParallelBuild(
+    It first, It last,
+    std::size_t num_threads = std::thread::hardware_concurrency()) -> Heap {
+  const auto n = static_cast<std::size_t>(std::distance(first, last));
+  // hardware_concurrency() may report 0 when it cannot tell
+  const auto max_parts = std::max<std::size_t>(num_threads, 1);
+  const auto parts =
+      std::clamp<std::size_t>(n / parallel_build_grain, 1, max_parts);
+  if (parts <= 1) {
+    return Heap(first, last);
+  }
+  const auto slice = [&](std::size_t i) {
+    return std::next(first, static_cast<std::ptrdiff_t>(i * n / parts));
+  };
+
+  // optional, as heaps with a const epsilon are not move-assignable
+  auto heaps = std::vector<std::optional<Heap>>(parts);
+  {
+    auto workers = std::vector<std::jthread>();
+    workers.reserve(parts - 1);
+    for (std::size_t i = 1; i < parts; ++i) {
+      workers.emplace_back(
+          [&, i] { heaps[i].emplace(slice(i), slice(i + 1)); });
+    }
+    heaps[0].emplace(slice(0), slice(1));
+  }
+
+  // Round k melds heaps[i + 2^k] into heaps[i] for every i divisible by
+  // 2^(k+1); the calling thread takes i = 0
+  for (std::size_t stride = 1; stride < parts; stride *= 2) {
+    auto workers = std::vector<std::jthread>();
+    for (auto i = 2 * stride; i + stride < parts; i += 2 * stride) {
+      workers.emplace_back([&heaps, i, stride] {
+        heaps[i]->Meld(std::move(*heaps[i + stride]));
+      });
+    }
+    heaps[0]->Meld(std::move(*heaps[stride]));
+  }
+  return std::move(*heaps[0]);
+}
+
+}  // namespace soft_heap
@@ -0,0 +1,238 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <optional>
+#include <utility>
+
+namespace soft_heap {
+
+// Root container indexed by rank. Tree r lives in slot r and an occupancy
+// bitmask gives the iteration order, so the trees behave like the digits of
+// a binary counter and walks over them stay within one contiguous block.
+// Slots are kept behind a pointer so that iterators (and the min_ckey
+// iterators stored in each tree) survive moving the owning heap. A moved-from
+// container has no slots: it reads as empty and the first Put allocates new
+// ones.
+template <class Tree>
+class RankedTrees {
+ public:
+  static constexpr int max_rank = 64;
+
+ private:
+  struct Slots {
+    std::uint64_t mask = 0;
+    std::array<std::optional<Tree>, max_rank> trees;
+  };
+
+ public:
+  template <bool is_const>
+  class Iterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = Tree;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<is_const, const Tree*, Tree*>;
+    using reference = std::conditional_t<is_const, const Tree&, Tree&>;
+
+    constexpr Iterator() noexcept = default;
+
+    constexpr Iterator(Slots* slots, int rank) noexcept
+        : slots(slots), slot_rank(rank) {}
+
+    constexpr operator Iterator<true>() const noexcept {  // NOLINT
+      return {slots, slot_rank};
+    }
+
+    [[nodiscard]] constexpr auto operator*() const noexcept -> reference {
+      return *slots->trees[slot_rank];
+    }
+
+    [[nodiscard]] constexpr auto operator->() const noexcept -> pointer {
+      return &*slots->trees[slot_rank];
+    }
+
+    constexpr auto operator++() noexcept -> Iterator& {
+      const auto above = (slot_rank + 1 < max_rank)
+                             ? slots->mask >> (slot_rank + 1)
+                             : std::uint64_t{0};
+      slot_rank =
+          (above == 0) ? max_rank : slot_rank + 1 + std::countr_zero(above);
+      return *this;
+    }
+
+    constexpr auto operator++(int) noexcept -> Iterator {
+      auto old = *this;
+      ++*this;
+      return old;
+    }
+
+    constexpr auto operator--() noexcept -> Iterator& {
+      const auto below =
+          (slot_rank < max_rank)
+              ? slots->mask & ((std::uint64_t{1} << slot_rank) - 1)
+              : slots->mask;
+      slot_rank = std::bit_width(below) - 1;
+      return *this;
+    }
+
+    constexpr auto operator--(int) noexcept -> Iterator {
+      auto old = *this;
+      --*this;
+      return old;
+    }
+
+    [[nodiscard]] constexpr auto rank() const noexcept { return slot_rank; }
+
+    [[nodiscard]] friend constexpr auto operator==(
+        const Iterator& x, const Iterator& y) noexcept -> bool {
+      return x.slot_rank == y.slot_rank;
+    }
+
+   private:
+    Slots* slots = nullptr;
+    int slot_rank = max_rank;
+  };
+
+  using value_type = Tree;
+  using size_type = std::size_t;
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  [[nodiscard]] constexpr auto begin() noexcept -> iterator {
+    return {slots.get(), First()};
+  }
+
+  [[nodiscard]] constexpr auto begin() const noexcept -> const_iterator {
+    return {slots.get(), First()};
+  }
+
+  [[nodiscard]] constexpr auto end() noexcept -> iterator {
+    return {slots.get(), max_rank};
+  }
+
+  [[nodiscard]] constexpr auto end() const noexcept -> const_iterator {
+    return {slots.get(), max_rank};
+  }
+
+  [[nodiscard]] constexpr auto size() const noexcept -> size_type {
+    return std::popcount(Mask());
+  }
+
+  [[nodiscard]] constexpr auto empty() const noexcept { return Mask() == 0; }
+
+  [[nodiscard]] constexpr auto front() noexcept -> Tree& { return *begin(); }
+
+  [[nodiscard]] constexpr auto front() const noexcept -> const Tree& {
+    return *begin();
+  }
+
+  [[nodiscard]] constexpr auto back() noexcept -> Tree& {
+    return *std::prev(end());
+  }
+
+  [[nodiscard]] constexpr auto back() const noexcept -> const Tree& {
+    return *std::prev(end());
+  }
+
+  // The tree in slot rank, which must be occupied
+  [[nodiscard]] constexpr auto At(int rank) noexcept -> iterator {
+    return {slots.get(), rank};
+  }
+
+  [[nodiscard]] constexpr auto At(int rank) const noexcept -> const_iterator {
+    return {slots.get(), rank};
+  }
+
+  [[nodiscard]] constexpr auto Occupied(int rank) const noexcept -> bool {
+    return ((Mask() >> rank) & 1) != 0;
+  }
+
+  constexpr auto Put(int rank, Tree&& tree) noexcept -> iterator {
+    if (slots == nullptr) [[unlikely]] {
+      slots = std::make_unique<Slots>();
+    }
+    slots->trees[rank].emplace(std::forward<Tree>(tree));
+    slots->mask |= std::uint64_t{1} << rank;
+    return {slots.get(), rank};
+  }
+
+  [[nodiscard]] constexpr auto Take(int rank) noexcept -> Tree {
+    auto tree = std::move(*slots->trees[rank]);
+    erase(iterator(slots.get(), rank));
+    return tree;
+  }
+
+  constexpr auto erase(iterator it) noexcept -> iterator {
+    slots->trees[it.rank()].reset();
+    slots->mask &= ~(std::uint64_t{1} << it.rank());
+    return ++it;
+  }
+
+  // Adds a tree of the given rank like a binary counter increment: while the
+  // slot is taken, link(into, from, new_rank) combines the two and the result
+  // moves up one rank. Returns the slot the tree finally landed in. Throws
+  // whatever link does, which may allocate.
+  template <class Link>
+  constexpr auto Carry(int rank, Tree&& tree, Link&& link) -> iterator {
+    auto carry = std::forward<Tree>(tree);
+    while (Occupied(rank)) {
+      auto& existing = *slots->trees[rank];
+      link(existing, std::move(carry), rank + 1);
+      carry = Take(rank);
+      ++rank;
+    }
+    return Put(rank, std::move(carry));
+  }
+
+  // Binary addition of two root arrays. Returns the highest slot written;
+  // only slots at or below it changed.
+  template <class Link>
+  constexpr auto Merge(RankedTrees&& that, Link&& link) -> iterator {
+    auto highest = begin();
+    while (not that.empty()) {
+      const auto rank = that.First();
+      const auto landed = Carry(rank, that.Take(rank), link);
+      if (highest == end() or landed.rank() > highest.rank()) {
+        highest = landed;
+      }
+    }
+    return highest;
+  }
+
+ private:
+  [[nodiscard]] constexpr auto Mask() const noexcept -> std::uint64_t {
+    return (slots == nullptr) ? 0 : slots->mask;
+  }
+
+  [[nodiscard]] constexpr auto First() const noexcept -> int {
+    const auto mask = Mask();
+    return (mask == 0) ? max_rank : std::countr_zero(mask);
+  }
+
+  std::unique_ptr<Slots> slots = std::make_unique<Slots>();
+};
+
+namespace policy {
+
+// Default: roots in a std::list sorted by rank.
+struct LinkedRoots {
+  template <class Tree>
+  using Container = std::list<Tree>;
+  static constexpr bool rank_indexed = false;
+};
+
+// Roots in a RankedTrees array; Insert and Meld become binary carries.
+struct RankedRoots {
+  template <class Tree>
+  using Container = RankedTrees<Tree>;
+  static constexpr bool rank_indexed = true;
+};
+
+}  // namespace policy
+
+}  // namespace soft_heap
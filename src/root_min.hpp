@@ -0,0 +1,309 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
+
+#if (defined(__x86_64__) or defined(__i386__)) and defined(__GNUC__)
+#include <immintrin.h>
+#define SOFT_HEAP_X86_SIMD 1
+#endif
+
+#include "order.hpp"
+#include "ranked_trees.hpp"
+
+namespace soft_heap {
+
+namespace detail {
+
+// First index of the minimum of keys[0, n), the scalar reference for the
+// vector kernels below
+template <class Key, class Order>
+[[nodiscard]] constexpr auto ScalarArgMin(const Key* keys, int n) noexcept
+    -> int {
+  auto min = 0;
+  for (int i = 1; i < n; ++i) {
+    if (Order::Less(keys[i], keys[min])) {
+      min = i;
+    }
+  }
+  return min;
+}
+
+#ifdef SOFT_HEAP_X86_SIMD
+
+// The kernels reduce to the minimum value, then find its first lane with an
+// equality mask, so ties go to the lowest index like ScalarArgMin. A NaN can
+// leave that minimum equal to no lane, so the search stops at n and hands
+// over to ScalarArgMin. n is a multiple of the vector width. Each is compiled
+// for its own target and only called once the CPU is known to support it.
+
+[[gnu::target("sse4.1")]] inline auto Sse41ArgMin(const std::int32_t* keys,
+                                                  int n) noexcept -> int {
+  auto m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys));
+  for (int i = 4; i < n; i += 4) {
+    m = _mm_min_epi32(
+        m, _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)));
+  }
+  m = _mm_min_epi32(m, _mm_shuffle_epi32(m, 0x4E));
+  m = _mm_min_epi32(m, _mm_shuffle_epi32(m, 0xB1));
+  for (int i = 0; i < n; i += 4) {
+    const auto eq = _mm_cmpeq_epi32(
+        m, _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)));
+    if (const auto mask = _mm_movemask_ps(_mm_castsi128_ps(eq))) {
+      return i + std::countr_zero(static_cast<unsigned>(mask));
+    }
+  }
+  return ScalarArgMin<std::int32_t, policy::NaturalOrder>(keys, n);
+}
+
+[[gnu::target("sse4.1")]] inline auto Sse41ArgMin(const float* keys,
+                                                  int n) noexcept -> int {
+  auto m = _mm_loadu_ps(keys);
+  for (int i = 4; i < n; i += 4) {
+    m = _mm_min_ps(m, _mm_loadu_ps(keys + i));
+  }
+  m = _mm_min_ps(m, _mm_shuffle_ps(m, m, 0x4E));
+  m = _mm_min_ps(m, _mm_shuffle_ps(m, m, 0xB1));
+  for (int i = 0; i < n; i += 4) {
+    if (const auto mask =
+            _mm_movemask_ps(_mm_cmpeq_ps(m, _mm_loadu_ps(keys + i)))) {
+      return i + std::countr_zero(static_cast<unsigned>(mask));
+    }
+  }
+  return ScalarArgMin<float, policy::NaturalOrder>(keys, n);
+}
+
+[[gnu::target("avx2")]] inline auto Avx2ArgMin(const std::int32_t* keys,
+                                               int n) noexcept -> int {
+  auto m = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys));
+  for (int i = 8; i < n; i += 8) {
+    m = _mm256_min_epi32(
+        m, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)));
+  }
+  m = _mm256_min_epi32(m, _mm256_permute2x128_si256(m, m, 1));
+  m = _mm256_min_epi32(m, _mm256_shuffle_epi32(m, 0x4E));
+  m = _mm256_min_epi32(m, _mm256_shuffle_epi32(m, 0xB1));
+  for (int i = 0; i < n; i += 8) {
+    const auto eq = _mm256_cmpeq_epi32(
+        m, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)));
+    if (const auto mask = _mm256_movemask_ps(_mm256_castsi256_ps(eq))) {
+      return i + std::countr_zero(static_cast<unsigned>(mask));
+    }
+  }
+  return ScalarArgMin<std::int32_t, policy::NaturalOrder>(keys, n);
+}
+
+// AVX2 has no 64-bit min instruction
+[[gnu::target("avx2")]] inline auto Avx2MinEpi64(__m256i x, __m256i y) noexcept
+    -> __m256i {
+  return _mm256_blendv_epi8(x, y, _mm256_cmpgt_epi64(x, y));
+}
+
+[[gnu::target("avx2")]] inline auto Avx2ArgMin(const std::int64_t* keys,
+                                               int n) noexcept -> int {
+  auto m = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys));
+  for (int i = 4; i < n; i += 4) {
+    m = Avx2MinEpi64(
+        m, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)));
+  }
+  m = Avx2MinEpi64(m, _mm256_permute4x64_epi64(m, 0x4E));
+  m = Avx2MinEpi64(m, _mm256_permute4x64_epi64(m, 0xB1));
+  for (int i = 0; i < n; i += 4) {
+    const auto eq = _mm256_cmpeq_epi64(
+        m, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)));
+    if (const auto mask = _mm256_movemask_pd(_mm256_castsi256_pd(eq))) {
+      return i + std::countr_zero(static_cast<unsigned>(mask));
+    }
+  }
+  return ScalarArgMin<std::int64_t, policy::NaturalOrder>(keys, n);
+}
+
+[[gnu::target("avx2")]] inline auto Avx2ArgMin(const float* keys,
+                                               int n) noexcept -> int {
+  auto m = _mm256_loadu_ps(keys);
+  for (int i = 8; i < n; i += 8) {
+    m = _mm256_min_ps(m, _mm256_loadu_ps(keys + i));
+  }
+  m = _mm256_min_ps(m, _mm256_permute2f128_ps(m, m, 1));
+  m = _mm256_min_ps(m, _mm256_shuffle_ps(m, m, 0x4E));
+  m = _mm256_min_ps(m, _mm256_shuffle_ps(m, m, 0xB1));
+  for (int i = 0; i < n; i += 8) {
+    const auto eq = _mm256_cmp_ps(m, _mm256_loadu_ps(keys + i), _CMP_EQ_OQ);
+    if (const auto mask = _mm256_movemask_ps(eq)) {
+      return i + std::countr_zero(static_cast<unsigned>(mask));
+    }
+  }
+  return ScalarArgMin<float, policy::NaturalOrder>(keys, n);
+}
+
+[[gnu::target("avx2")]] inline auto Avx2ArgMin(const double* keys,
+                                               int n) noexcept -> int {
+  auto m = _mm256_loadu_pd(keys);
+  for (int i = 4; i < n; i += 4) {
+    m = _mm256_min_pd(m, _mm256_loadu_pd(keys + i));
+  }
+  m = _mm256_min_pd(m, _mm256_permute2f128_pd(m, m, 1));
+  m = _mm256_min_pd(m, _mm256_shuffle_pd(m, m, 0x5));
+  for (int i = 0; i < n; i += 4) {
+    const auto eq = _mm256_cmp_pd(m, _mm256_loadu_pd(keys + i), _CMP_EQ_OQ);
+    if (const auto mask = _mm256_movemask_pd(eq)) {
+      return i + std::countr_zero(static_cast<unsigned>(mask));
+    }
+  }
+  return ScalarArgMin<double, policy::NaturalOrder>(keys, n);
+}
+
+#endif  // SOFT_HEAP_X86_SIMD
+
+enum class Isa { kScalar, kSse41, kAvx2 };
+
+// Best instruction set the running CPU offers, probed on the first call
+// only; that may come from a static initializer, before the CPU model is
+// otherwise set up
+[[nodiscard]] inline auto HostIsa() noexcept -> Isa {
+#ifdef SOFT_HEAP_X86_SIMD
+  static const auto isa = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2")     ? Isa::kAvx2
+           : __builtin_cpu_supports("sse4.1") ? Isa::kSse41
+                                              : Isa::kScalar;
+  }();
+  return isa;
+#else
+  return Isa::kScalar;
+#endif
+}
+
+// Keys with a vector kernel, under operator<
+template <class Key>
+concept SimdKey =
+    std::same_as<Key, std::int32_t> or std::same_as<Key, std::int64_t> or
+    std::same_as<Key, float> or std::same_as<Key, double>;
+
+// ArgMin over keys[0, n) with the widest kernel the CPU and key type allow
+template <SimdKey Key>
+[[nodiscard]] inline auto ArgMin(const Key* keys, int n, Isa isa) noexcept
+    -> int {
+#ifdef SOFT_HEAP_X86_SIMD
+  if (isa == Isa::kAvx2) {
+    return Avx2ArgMin(keys, n);
+  }
+  if constexpr (std::same_as<Key, std::int32_t> or std::same_as<Key, float>) {
+    if (isa == Isa::kSse41) {
+      return Sse41ArgMin(keys, n);
+    }
+  }
+#endif
+  return ScalarArgMin<Key, policy::NaturalOrder>(keys, n);
+}
+
+// Stands in for RootKeys under suffix-min tracking
+struct NoRootKeys {};
+
+}  // namespace detail
+
+// The ckeys of rank-indexed roots mirrored in one array, so the minimum root
+// is found by scanning at most 64 contiguous keys rather than through
+// per-tree suffix-min iterators. Empty ranks hold the largest key when a
+// vector kernel is used; a tie with a real key there is settled by a scalar
+// pass over the occupied ranks.
+template <class Key, class Order>
+class RootKeys {
+ public:
+  static constexpr int max_rank = 64;
+  static constexpr bool vectorized =
+      detail::SimdKey<Key> and requires {
+        requires std::same_as<typename Order::CompareType, std::less<>>;
+      };
+
+  constexpr RootKeys() noexcept {
+    if constexpr (vectorized) {
+      keys.fill(std::numeric_limits<Key>::max());
+    }
+  }
+
+  constexpr void Set(int rank, const Key& key) noexcept {
+    keys[rank] = key;
+    mask |= std::uint64_t{1} << rank;
+  }
+
+  constexpr void Clear(int rank) noexcept {
+    if constexpr (vectorized) {
+      keys[rank] = std::numeric_limits<Key>::max();
+    }
+    mask &= ~(std::uint64_t{1} << rank);
+  }
+
+  // Rank of the first minimum root. Requires at least one root.
+  [[nodiscard]] auto ArgMin() const noexcept -> int {
+    if constexpr (vectorized) {
+      const auto isa = detail::HostIsa();
+      if (isa != detail::Isa::kScalar) {
+        // up to the highest root, rounded to a whole number of vectors
+        const auto n = (std::bit_width(mask) + 7) & ~7;
+        const auto rank = detail::ArgMin(keys.data(), n, isa);
+        if (((mask >> rank) & 1) != 0) {
+          return rank;
+        }
+      }
+    }
+    return ScanOccupied();
+  }
+
+  [[nodiscard]] auto ScanOccupied() const noexcept -> int {
+    auto rest = mask;
+    auto min = std::countr_zero(rest);
+    for (rest &= rest - 1; rest != 0; rest &= rest - 1) {
+      const auto rank = std::countr_zero(rest);
+      if (Order::Less(keys[rank], keys[min])) {
+        min = rank;
+      }
+    }
+    return min;
+  }
+
+ private:
+  std::array<Key, max_rank> keys{};
+  std::uint64_t mask = 0;
+};
+
+namespace policy {
+
+// Default for non-vectorizable keys: every root caches an iterator to the
+// minimum root at or above its rank, refreshed back to the front of the root
+// list after each change
+struct SuffixMinRoots {
+  template <class Roots, class Key, class Order>
+  static constexpr bool scan = false;
+};
+
+// Root ckeys in a RootKeys array, scanned on every ExtractMin and Top.
+// Refilling the min root then updates one key instead of the suffix minima.
+// Requires rank-indexed roots.
+struct ScanMinRoots {
+  template <class Roots, class Key, class Order>
+  static constexpr bool scan = true;
+};
+
+// ScanMinRoots for rank-indexed roots with a vectorizable key, otherwise
+// SuffixMinRoots
+struct AutoMinRoots {
+  template <class Roots, class Key, class Order>
+  static constexpr bool scan = Roots::rank_indexed and
+                               RootKeys<Key, Order>::vectorized;
+};
+
+template <class Tracking>
+concept RootMinTracking = requires {
+  {
+    Tracking::template scan<LinkedRoots, int, NaturalOrder>
+  } -> std::convertible_to<bool>;
+};
+
+}  // namespace policy
+
+}  // namespace soft_heap
@@ -0,0 +1,202 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "flat_soft_heap.hpp"
+#include "inline_list.hpp"
+#include "node_pool.hpp"
+#include "order.hpp"
+#include "policies.hpp"
+#include "ranked_trees.hpp"
+#include "soft_heap.hpp"
+#include "utility.hpp"
+
+namespace soft_heap {
+
+namespace detail {
+
+// Inverse epsilons with a compiled kernel, by increasing rank threshold. The
+// last one never corrupts below 2^36 elements and catches everything else.
+inline constexpr auto kernel_inverse_epsilons =
+    std::array{2, 4, 8, 16, 32, 1000, INT_MAX};
+
+template <template <int> class Heap, class Indices>
+struct KernelVariant;
+
+template <template <int> class Heap, std::size_t... i>
+struct KernelVariant<Heap, std::index_sequence<i...>> {
+  using type = std::variant<Heap<kernel_inverse_epsilons[i]>...>;
+};
+
+}  // namespace detail
+
+// Soft heap whose epsilon is picked at run time. The rank threshold
+// r = ceil(log2(1/epsilon)) + 5 is computed once in the constructor and
+// selects the compile-time kernel with the smallest threshold >= r, so the
+// requested bound always holds and the common epsilons (1/2 .. 1/32, 1/1000)
+// run exactly as their static counterparts. Every operation is then a single
+// switch on the kernel index followed by the fully inlined static code.
+// Any double is accepted as epsilon: 0, negative values and NaN mean exact,
+// 1 and above, infinity included, the loosest kernel.
+template <policy::TotalOrdered Element, template <int> class Heap>
+class RuntimeEpsilonHeap {
+ public:
+  using Kernels = typename detail::KernelVariant<
+      Heap, std::make_index_sequence<
+                detail::kernel_inverse_epsilons.size()>>::type;
+  using Key = typename std::variant_alternative_t<0, Kernels>::Key;
+
+  constexpr explicit RuntimeEpsilonHeap(double epsilon) noexcept
+      : heap(MakeKernel(Threshold(epsilon))), requested(epsilon) {}
+
+  constexpr RuntimeEpsilonHeap(double epsilon, std::input_iterator auto first,
+                               std::input_iterator auto last) noexcept
+      : heap(MakeKernel(Threshold(epsilon), first, last)),
+        requested(epsilon) {}
+
+  constexpr void Insert(Element e) noexcept {
+    std::visit([&](auto& kernel) { kernel.Insert(std::move(e)); }, heap);
+  }
+
+  constexpr void InsertRange(std::input_iterator auto first,
+                             std::input_iterator auto last) noexcept {
+    std::visit([&](auto& kernel) { kernel.InsertRange(first, last); }, heap);
+  }
+
+  // Heaps on the same kernel meld structurally. Otherwise the elements of P
+  // are drained into this heap, which keeps this heap's error bound.
+  constexpr void Meld(RuntimeEpsilonHeap&& P) noexcept {
+    if (heap.index() != P.heap.index()) {
+      while (P.size() != 0) {
+        Insert(P.ExtractMin());
+      }
+      return;
+    }
+    std::visit(
+        [&](auto& kernel) {
+          using Kernel = std::remove_reference_t<decltype(kernel)>;
+          kernel.Meld(std::move(std::get<Kernel>(P.heap)));
+        },
+        heap);
+  }
+
+  [[nodiscard]] constexpr auto ExtractMin() noexcept -> Element {
+    return std::visit([](auto& kernel) { return kernel.ExtractMin(); }, heap);
+  }
+
+  template <std::output_iterator<Element> Out>
+  constexpr auto ExtractMinBatch(Out out, std::size_t k) noexcept -> Out {
+    return std::visit(
+        [&](auto& kernel) { return kernel.ExtractMinBatch(out, k); }, heap);
+  }
+
+  constexpr auto ExtractMinBatch(std::span<Element> out) noexcept
+      -> std::size_t {
+    return std::visit(
+        [&](auto& kernel) { return kernel.ExtractMinBatch(out); }, heap);
+  }
+
+  [[nodiscard]] constexpr auto Top() const noexcept -> const Element& {
+    return std::visit(
+        [](const auto& kernel) -> const Element& { return kernel.Top(); },
+        heap);
+  }
+
+  [[nodiscard]] constexpr auto TopCKey() const noexcept -> const Key& {
+    return std::visit(
+        [](const auto& kernel) -> const Key& { return kernel.TopCKey(); },
+        heap);
+  }
+
+  [[nodiscard]] constexpr auto TryExtractMinIf(auto&& pred) noexcept
+      -> std::optional<Element> {
+    return std::visit(
+        [&](auto& kernel) { return kernel.TryExtractMinIf(pred); }, heap);
+  }
+
+  [[nodiscard]] constexpr auto size() const noexcept -> std::size_t {
+    return std::visit([](const auto& kernel) { return kernel.size(); }, heap);
+  }
+
+  [[nodiscard]] constexpr auto num_corrupted_keys() noexcept {
+    return std::visit(
+        [](auto& kernel) { return kernel.num_corrupted_keys(); }, heap);
+  }
+
+  // The epsilon asked for, and the rank threshold of the kernel running it
+  [[nodiscard]] constexpr auto epsilon() const noexcept { return requested; }
+
+  [[nodiscard]] constexpr auto threshold() const noexcept -> int {
+    return RankThreshold(detail::kernel_inverse_epsilons[heap.index()]);
+  }
+
+ private:
+  // Tested as not (epsilon > 0) so that NaN is caught here too: std::clamp
+  // passes it through, and RankThreshold would convert it to an int
+  [[nodiscard]] static constexpr auto Threshold(double epsilon) noexcept {
+    if (not(epsilon > 0)) {
+      return RankThreshold(double{INT_MAX});
+    }
+    return RankThreshold(std::clamp(1.0 / epsilon, 1.0, double{INT_MAX}));
+  }
+
+  template <std::size_t i = 0>
+  [[nodiscard]] static constexpr auto MakeKernel(int threshold,
+                                                 auto&&... args) noexcept
+      -> Kernels {
+    if constexpr (i + 1 < std::variant_size_v<Kernels>) {
+      if (threshold > RankThreshold(detail::kernel_inverse_epsilons[i])) {
+        return MakeKernel<i + 1>(threshold, args...);
+      }
+    }
+    return Kernels(std::in_place_index<i>, args...);
+  }
+
+  Kernels heap;
+  double requested;
+};
+
+namespace detail {
+
+template <class Element, class List, class Allocation, class Roots,
+          class Order>
+struct SoftHeapKernel {
+  template <int inverse_epsilon>
+  using Heap =
+      SoftHeap<Element, List, inverse_epsilon, Allocation, Roots, Order>;
+};
+
+template <class Element, class List, class Roots, class Order>
+struct FlatSoftHeapKernel {
+  template <int inverse_epsilon>
+  using Heap = FlatSoftHeap<Element, List, inverse_epsilon, Roots, Order>;
+};
+
+}  // namespace detail
+
+template <policy::TotalOrdered Element,
+          policy::TotalOrderedContainer List = InlineList<Element>,
+          policy::NodeAllocation Allocation = policy::HeapAllocation,
+          policy::RootContainer Roots = policy::LinkedRoots,
+          policy::ElementOrder<Element> Order = policy::NaturalOrder>
+using RuntimeSoftHeap = RuntimeEpsilonHeap<
+    Element, detail::SoftHeapKernel<Element, List, Allocation, Roots,
+                                    Order>::template Heap>;
+
+template <policy::TotalOrdered Element,
+          policy::TotalOrderedContainer List = InlineList<Element>,
+          policy::RootContainer Roots = policy::LinkedRoots,
+          policy::ElementOrder<Element> Order = policy::NaturalOrder>
+using RuntimeFlatSoftHeap = RuntimeEpsilonHeap<
+    Element,
+    detail::FlatSoftHeapKernel<Element, List, Roots, Order>::template Heap>;
+
+}  // namespace soft_heap
@@ -0,0 +1,248 @@
+#pragma once
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "policies.hpp"
+
+namespace soft_heap {
+
+// Element list made of a doubly-linked chain of fixed-capacity segments.
+// Appending another list relinks its segments in O(1) (std::list-style
+// splice), while pop_back and iteration stay within contiguous storage. An
+// invariant is that no segment in the chain is ever empty.
+template <class T, std::size_t segment_capacity = 8>
+class SegmentedList {
+  static_assert(segment_capacity > 0);
+
+  struct Segment {
+    [[nodiscard]] auto data() noexcept -> T* {
+      return std::launder(reinterpret_cast<T*>(storage));
+    }
+
+    Segment* prev = nullptr;
+    Segment* next = nullptr;
+    std::size_t count = 0;
+    alignas(T) std::byte storage[sizeof(T) * segment_capacity];
+  };
+
+ public:
+  template <bool is_const>
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<is_const, const T*, T*>;
+    using reference = std::conditional_t<is_const, const T&, T&>;
+
+    constexpr Iterator() noexcept = default;
+
+    constexpr Iterator(Segment* segment, std::size_t index) noexcept
+        : segment(segment), index(index) {}
+
+    constexpr operator Iterator<true>() const noexcept {  // NOLINT
+      return {segment, index};
+    }
+
+    [[nodiscard]] auto operator*() const noexcept -> reference {
+      return segment->data()[index];
+    }
+
+    [[nodiscard]] auto operator->() const noexcept -> pointer {
+      return segment->data() + index;
+    }
+
+    constexpr auto operator++() noexcept -> Iterator& {
+      if (++index == segment->count) {
+        segment = segment->next;
+        index = 0;
+      }
+      return *this;
+    }
+
+    constexpr auto operator++(int) noexcept -> Iterator {
+      auto old = *this;
+      ++*this;
+      return old;
+    }
+
+    [[nodiscard]] friend constexpr auto operator==(
+        const Iterator& x, const Iterator& y) noexcept -> bool {
+      return x.segment == y.segment and x.index == y.index;
+    }
+
+   private:
+    Segment* segment = nullptr;
+    std::size_t index = 0;
+  };
+
+  using value_type = T;
+  using reference = T&;
+  using const_reference = const T&;
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+  using difference_type = std::ptrdiff_t;
+  using size_type = std::size_t;
+
+  SegmentedList() noexcept = default;
+
+  SegmentedList(std::initializer_list<T> init) noexcept {
+    for (const auto& x : init) {
+      push_back(x);
+    }
+  }
+
+  SegmentedList(const SegmentedList& that) noexcept {
+    for (const auto& x : that) {
+      push_back(x);
+    }
+  }
+
+  SegmentedList(SegmentedList&& that) noexcept
+      : head(std::exchange(that.head, nullptr)),
+        tail(std::exchange(that.tail, nullptr)),
+        count(std::exchange(that.count, 0)) {}
+
+  auto operator=(SegmentedList that) noexcept -> SegmentedList& {
+    swap(that);
+    return *this;
+  }
+
+  ~SegmentedList() { clear(); }
+
+  [[nodiscard]] auto begin() noexcept -> iterator { return {head, 0}; }
+  [[nodiscard]] auto begin() const noexcept -> const_iterator {
+    return {head, 0};
+  }
+  [[nodiscard]] auto cbegin() const noexcept -> const_iterator {
+    return {head, 0};
+  }
+  [[nodiscard]] auto end() noexcept -> iterator { return {}; }
+  [[nodiscard]] auto end() const noexcept -> const_iterator { return {}; }
+  [[nodiscard]] auto cend() const noexcept -> const_iterator { return {}; }
+
+  [[nodiscard]] auto size() const noexcept -> size_type { return count; }
+
+  [[nodiscard]] auto max_size() const noexcept -> size_type {
+    return std::numeric_limits<difference_type>::max();
+  }
+
+  [[nodiscard]] auto empty() const noexcept { return count == 0; }
+
+  [[nodiscard]] auto back() noexcept -> reference {
+    return tail->data()[tail->count - 1];
+  }
+
+  [[nodiscard]] auto back() const noexcept -> const_reference {
+    return tail->data()[tail->count - 1];
+  }
+
+  template <class... Args>
+  auto emplace_back(Args&&... args) noexcept -> reference {
+    if (tail == nullptr or tail->count == segment_capacity) {
+      LinkBack(new Segment);
+    }
+    auto* elem = ::new (tail->data() + tail->count)
+        T(std::forward<Args>(args)...);
+    ++tail->count;
+    ++count;
+    return *elem;
+  }
+
+  void push_back(const T& elem) noexcept { emplace_back(elem); }
+  void push_back(T&& elem) noexcept { emplace_back(std::move(elem)); }
+
+  void pop_back() noexcept {
+    std::destroy_at(tail->data() + --tail->count);
+    --count;
+    if (tail->count == 0) {
+      auto* const old = tail;
+      tail = old->prev;
+      (tail == nullptr ? head : tail->next) = nullptr;
+      delete old;
+    }
+  }
+
+  void clear() noexcept {
+    while (head != nullptr) {
+      std::destroy_n(head->data(), head->count);
+      delete std::exchange(head, head->next);
+    }
+    tail = nullptr;
+    count = 0;
+  }
+
+  // Moves every element of that to the back of this list. Only pos == end()
+  // is supported. Segments are relinked rather than copied, except that a
+  // single short segment is folded into free space at our tail to limit
+  // fragmentation.
+  void splice([[maybe_unused]] const_iterator pos,
+              SegmentedList& that) noexcept {
+    if (that.head == nullptr or &that == this) {
+      return;
+    }
+    if (tail != nullptr and that.head == that.tail and
+        tail->count + that.head->count <= segment_capacity) {
+      auto* from = that.head->data();
+      std::uninitialized_move_n(from, that.head->count,
+                                tail->data() + tail->count);
+      std::destroy_n(from, that.head->count);
+      tail->count += that.head->count;
+      count += that.head->count;
+      delete that.head;
+    } else {
+      that.head->prev = tail;
+      (tail == nullptr ? head : tail->next) = that.head;
+      tail = that.tail;
+      count += that.count;
+    }
+    that.head = that.tail = nullptr;
+    that.count = 0;
+  }
+
+  void splice(const_iterator pos, SegmentedList&& that) noexcept {
+    splice(pos, that);
+  }
+
+  void swap(SegmentedList& that) noexcept {
+    std::swap(head, that.head);
+    std::swap(tail, that.tail);
+    std::swap(count, that.count);
+  }
+
+  friend void swap(SegmentedList& x, SegmentedList& y) noexcept { x.swap(y); }
+
+  [[nodiscard]] friend auto operator==(const SegmentedList& x,
+                                       const SegmentedList& y) noexcept
+      -> bool {
+    return x.size() == y.size() and std::equal(x.begin(), x.end(), y.begin());
+  }
+
+  [[nodiscard]] friend auto operator<=>(const SegmentedList& x,
+                                        const SegmentedList& y) noexcept {
+    return std::lexicographical_compare_three_way(x.begin(), x.end(),
+                                                  y.begin(), y.end());
+  }
+
+ private:
+  void LinkBack(Segment* segment) noexcept {
+    segment->prev = tail;
+    (tail == nullptr ? head : tail->next) = segment;
+    tail = segment;
+  }
+
+  Segment* head = nullptr;
+  Segment* tail = nullptr;
+  size_type count = 0;
+};
+static_assert(policy::SpliceableContainer<SegmentedList<int>>);
+
+}  // namespace soft_heap
@@ -7,49 +7,126 @@
 #include <iterator>
 #include <list>
 #include <memory>
+#include <optional>
 #include <set>
+#include <span>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "inline_list.hpp"
+#include "node_pool.hpp"
+#include "order.hpp"
 #include "policies.hpp"
+#include "ranked_trees.hpp"
+#include "root_min.hpp"
+#include "stats.hpp"
+#include "tombstones.hpp"
 #include "tree.hpp"
 #include "utility.hpp"
 
 namespace soft_heap {
 
 template <policy::TotalOrdered Element,
-          policy::TotalOrderedContainer List = std::vector<Element>,
-          int inverse_epsilon = 8>
+          policy::TotalOrderedContainer List = InlineList<Element>,
+          int inverse_epsilon = 8,
+          policy::NodeAllocation Allocation = policy::HeapAllocation,
+          policy::RootContainer Roots = policy::LinkedRoots,
+          policy::ElementOrder<Element> Order = policy::NaturalOrder,
+          policy::RootMinTracking Tracking = policy::AutoMinRoots,
+          policy::OperationStats Stats = policy::NoStats,
+          policy::TombstoneTracking Tombstones = policy::NoTombstones>
 class SoftHeap {
  public:
-  using NodePtr = std::unique_ptr<Node<Element, List, inverse_epsilon>>;
-  using TreeList = std::list<Tree<Element, List, inverse_epsilon>>;
+  using NodeType = Node<Element, List, inverse_epsilon, Allocation, Order>;
+  using NodePtr = typename NodeType::NodePtr;
+  using Key = typename NodeType::Key;
+  using TreeType =
+      Tree<Element, List, inverse_epsilon, Allocation, Roots, Order>;
+  using TreeList = typename Roots::template Container<TreeType>;
   using TreeListIt = typename TreeList::iterator;
 
-  SoftHeap() = default;
+  // Whether the minimum root is found by scanning root_keys instead of
+  // following suffix-min iterators, see policy::AutoMinRoots
+  static constexpr bool scan_roots =
+      Tracking::template scan<Roots, Key, Order>;
+  static_assert(not scan_roots or Roots::rank_indexed,
+                "ScanMinRoots needs rank-indexed roots");
+
+  constexpr SoftHeap() noexcept : epsilon(1.0 / inverse_epsilon), c_size(0) {}
+
+  // Leaves that an empty heap, ready for reuse
+  constexpr SoftHeap(SoftHeap&& that) noexcept : SoftHeap() { Swap(that); }
+
+  // Our old trees go out through a temporary that also holds the resource
+  // their nodes came from, so they are released before it is
+  constexpr auto operator=(SoftHeap&& that) noexcept -> SoftHeap& {
+    SoftHeap(std::move(that)).Swap(*this);
+    return *this;
+  }
 
   constexpr explicit SoftHeap(Element&& element) noexcept
-      : epsilon(1.0 / inverse_epsilon), c_size(1) {
-    trees.emplace_back(std::forward<Element>(element));
-    trees.begin()->min_ckey = trees.begin();
+      : epsilon(1.0 / inverse_epsilon), c_size(0) {
+    Insert(std::forward<Element>(element));
   }
 
+  // Bulk build: leaves are carried into a scratch rank-indexed forest in one
+  // pass, which yields the same trees as repeated Insert without walking the
+  // root list or updating suffix minima until the very end. Keys are copied,
+  // as std::priority_queue does; pass move iterators to move them instead.
   constexpr SoftHeap(std::input_iterator auto first,
-                     std::input_iterator auto last) noexcept
-      : SoftHeap(std::move(*first)) {
-    std::for_each(std::next(first), last,
-                  [&](auto&& e) { Insert(std::forward<Element>(e)); });
+                     std::input_iterator auto last)
+      : epsilon(1.0 / inverse_epsilon), c_size(0) {
+    if constexpr (std::forward_iterator<decltype(first)>) {
+      node_resource.Reserve(2 * std::distance(first, last));
+    }
+    auto forest = RankedTrees<TreeType>();
+    for (; first != last; ++first, ++c_size) {
+      counters.OnInsert();
+      forest.Carry(0, TreeType(MakeNodePtr(Element(*first))), Link());
+    }
+    if constexpr (Roots::rank_indexed) {
+      trees = std::move(forest);
+    } else {
+      for (auto& tree : forest) {
+        trees.push_back(std::move(tree));
+      }
+    }
+    if (not trees.empty()) {
+      UpdateSuffixMin(std::prev(trees.end()));
+    }
+  }
+
+  // Under a tracking Tombstones policy the element is tagged on the way in
+  // and its handle for Delete and DecreaseKey is returned
+  constexpr auto Insert(Element e) noexcept {
+    if constexpr (Tombstones::tracked) {
+      const auto handle = handles.Track(e);
+      Push(std::move(e));
+      PurgeTop();
+      return handle;
+    } else {
+      Push(std::move(e));
+    }
   }
 
-  constexpr void Insert(Element e) noexcept {
+  constexpr void Push(Element e) noexcept
+    requires Roots::rank_indexed
+  {
+    ++c_size;
+    counters.OnInsert();
+    UpdateSuffixMin(
+        trees.Carry(0, TreeType(MakeNodePtr(std::move(e))), Link()));
+  }
+
+  constexpr void Push(Element e) noexcept {
     // auto node = Node(e);
     ++c_size;
+    counters.OnInsert();
     auto first_tree = trees.begin();
     if (std::ssize(trees) != 0 and first_tree->rank() == 0) {
-      first_tree->root = MakeNodePtr(
-          std::move(first_tree->root),
-          std::make_unique<Node<Element, List, inverse_epsilon>>(std::move(e)));
+      first_tree->root =
+          MakeNodePtr(std::move(first_tree->root), MakeNodePtr(std::move(e)));
       // compare new node to first tree's root
       // tree->root = MakeNodePtr(std::move(tree->root), std::move(node));
       for (auto tree = trees.begin(); tree != trees.end();
@@ -66,85 +143,181 @@ class SoftHeap {
         }
       }
     } else {
-      trees.emplace_front(std::forward<Element>(e));
-      trees.begin()->min_ckey = trees.begin();
+      trees.emplace_front(MakeNodePtr(std::forward<Element>(e)));
+      UpdateSuffixMin(trees.begin());
     }
     // Meld(SoftHeap(std::forward<Element>(e)));
   }
 
-  constexpr void Meld(SoftHeap&& P) noexcept {
-    if (std::ssize(trees) != 0 && P.rank() > rank()) {
-      trees.swap(P.trees);
+  // Bulk-builds the burst as a heap of its own and melds it in once, so the
+  // carries and the suffix-min pass are paid per range rather than per key
+  constexpr void InsertRange(std::input_iterator auto first,
+                             std::input_iterator auto last) {
+    auto burst = SoftHeap(first, last);
+    if (not burst.trees.empty()) {
+      Absorb(std::move(burst));
     }
-    const auto p_rank = P.rank();
-    trees.merge(P.trees);
+    if constexpr (Tombstones::tracked) {
+      PurgeTop();
+    }
+  }
 
-    for (auto tree = trees.begin(); tree != trees.end();
-         std::advance(tree, 1)) {
-      if (std::next(tree) != trees.end() and
-          tree->rank() == std::next(tree)->rank()) {
-        tree->root = MakeNodePtr(std::move(tree->root),
-                                 std::move(std::next(tree)->root));
-        trees.erase(std::next(tree));
-        std::advance(tree, -1);
-      } else if (tree->rank() > p_rank) {
-        UpdateSuffixMin(tree);
-        return;
-      }
+  // Melding two heaps that hand out handles would mix up their slots, so
+  // those only take in untracked entries, through InsertRange
+  constexpr void Meld(SoftHeap&& P) noexcept
+    requires(not Tombstones::tracked)
+  {
+    Absorb(std::move(P));
+  }
+
+  // Lazy deletion, see policy::GenerationTombstones. The entry stays in its
+  // list until a sift or the top reaches it; once tombstones outnumber the
+  // live elements they are all purged in one pass. Returns false for a
+  // stale handle.
+  constexpr auto Delete(Handle handle) noexcept -> bool
+    requires Tombstones::tracked
+  {
+    if (not handles.Live(handle)) {
+      return false;
     }
-    UpdateSuffixMin(std::prev(trees.end()));
+    handles.Release(handle);
+    --c_size;
+    ++num_dead;
+    if (num_dead > c_size) {
+      Purge();
+    } else {
+      PurgeTop();
+    }
+    return true;
+  }
+
+  // A soft heap cannot move a key up in place, so this is Delete plus
+  // Insert. Returns the new handle, or nothing if the handle was stale.
+  constexpr auto DecreaseKey(Handle handle, Element e) noexcept
+      -> std::optional<Handle>
+    requires Tombstones::tracked
+  {
+    if (not Delete(handle)) {
+      return std::nullopt;
+    }
+    return Insert(std::move(e));
+  }
+
+  [[nodiscard]] constexpr auto Contains(Handle handle) const noexcept -> bool
+    requires Tombstones::tracked
+  {
+    return handles.Live(handle);
+  }
+
+  // Deleted elements whose entries are still in the lists
+  [[nodiscard]] constexpr auto tombstones() const noexcept -> std::size_t
+    requires Tombstones::tracked
+  {
+    return num_dead;
+  }
+
+  // The element ExtractMin would return next, read in O(1) off the cached
+  // suffix minimum or a scan of the root keys. Requires a non-empty heap.
+  [[nodiscard]] constexpr auto Top() const noexcept -> const Element& {
+    return MinRoot().root->elements.back();
+  }
+
+  // The (possibly corrupted) key that Top() is ordered by
+  [[nodiscard]] constexpr auto TopCKey() const noexcept -> const Key& {
+    return MinRoot().root->ckey;
+  }
+
+  // Extracts Top() only if pred accepts it; a declined peek touches nothing
+  [[nodiscard]] constexpr auto TryExtractMinIf(auto&& pred) noexcept
+      -> std::optional<Element> {
+    if (trees.empty() or not pred(Top())) {
+      return std::nullopt;
+    }
+    return ExtractMin();
   }
 
   [[nodiscard]] constexpr auto ExtractMin() noexcept {
-    const auto& min_tree = trees.front().min_ckey;
-    const auto& x = min_tree->root;
-    const auto first_elem = x->back();
-    x->pop_back();
-    if (2 * std::ssize(x->elements) < x->size) {
-      if (not x->IsLeaf()) {
-        x->Sift();
-        UpdateSuffixMin(min_tree);
-      } else if (x->elements.empty()) {
-        if (min_tree != trees.begin()) {
-          const auto prev = std::prev(min_tree);
-          trees.erase(min_tree);
-          UpdateSuffixMin(prev);
-        } else {
-          trees.erase(min_tree);
+    const auto min_tree = MinTree();
+    auto [first_elem, corrupted] = min_tree->root->TakeBack();
+    num_corrupted -= corrupted ? 1 : 0;
+    Refill(min_tree);
+    --c_size;
+    counters.OnExtract();
+    if constexpr (Tombstones::tracked) {
+      handles.Release(first_elem);
+      PurgeTop();
+    }
+    return first_elem;
+  }
+
+  // Writes up to k elements to out, in the order repeated ExtractMin would
+  // produce them modulo corruption. The min root is drained in one go and
+  // only sifted, with its suffix-min update, once it runs dry or the batch
+  // ends, rather than every time it drops below half full.
+  template <std::output_iterator<Element> Out>
+  constexpr auto ExtractMinBatch(Out out, std::size_t k) noexcept -> Out {
+    while (k != 0 and not trees.empty()) {
+      const auto min_tree = MinTree();
+      auto& root = *min_tree->root;
+      for (auto n = std::min(k, std::size(root.elements)); n != 0; --n) {
+        auto [element, corrupted] = root.TakeBack();
+        num_corrupted -= corrupted ? 1 : 0;
+        if constexpr (Tombstones::tracked) {
+          if (handles.Dead(element)) {
+            --num_dead;
+            continue;
+          }
+          handles.Release(element);
         }
+        *out++ = std::move(element);
+        --k;
+        --c_size;
+        counters.OnExtract();
       }
+      Refill(min_tree);
     }
-    --c_size;
-    return first_elem;
+    if constexpr (Tombstones::tracked) {
+      PurgeTop();
+    }
+    return out;
+  }
+
+  // Returns the number of elements written to the front of out
+  constexpr auto ExtractMinBatch(std::span<Element> out) noexcept
+      -> std::size_t {
+    return std::distance(out.begin(),
+                         ExtractMinBatch(out.begin(), out.size()));
   }
 
+  // Also reports the keys corrupted along the way
   [[nodiscard]] auto ExtractMinC() noexcept
-      -> std::pair<Element, std::vector<Element>> {
-    const auto& min_tree = trees.front().min_ckey;
+      -> std::pair<Element, std::vector<Key>> {
+    const auto min_tree = MinTree();
     const auto& x = min_tree->root;
-    const auto first_elem = x->back();
-    std::vector<Element> corrupted_elements;
-    x->pop_back();
-    if (first_elem == x->ckey) {
+    const auto [first_elem, corrupted] = x->TakeBack();
+    num_corrupted -= corrupted ? 1 : 0;
+    --c_size;
+    std::vector<Key> corrupted_elements;
+    counters.OnExtract();
+    if (Order::Equivalent(Order::Key(first_elem), x->ckey)) {
       x->ckey_present = false;
       // Soft Select algo specifies adding min element to list of corrupted
       // elements if element is not corrupted
-      corrupted_elements.push_back(first_elem);
+      corrupted_elements.push_back(Order::Key(first_elem));
     }
     if (2 * std::ssize(x->elements) < x->size) {
       if (not x->IsLeaf()) {
-        x->SiftC(corrupted_elements);
-        UpdateSuffixMin(min_tree);
+        auto prune = Prune();
+        num_corrupted += x->SiftC(corrupted_elements, counters, prune);
+        RefreshRoot(min_tree);
       } else if (x->elements.empty()) {
-        if (min_tree != trees.begin()) {
-          const auto prev = std::prev(min_tree);
-          trees.erase(min_tree);
-          UpdateSuffixMin(prev);
-        } else {
-          trees.erase(min_tree);
-        }
+        EraseRoot(min_tree);
       }
     }
+    if constexpr (Tombstones::tracked) {
+      handles.Release(first_elem);
+      PurgeTop();
+    }
     return std::make_pair(first_elem, corrupted_elements);
   }
 
@@ -158,48 +331,271 @@ class SoftHeap {
     return out;
   }
 
-  [[nodiscard]] constexpr auto num_corrupted_keys() noexcept {
-    int num = 0;
-    for (auto& tree : trees) {
-      num += tree.num_corrupted_keys();
-    }
-    return num;
+  // Elements whose key is below their node's ckey. Kept up to date by every
+  // sift, extraction and meld, so reading it never walks the trees.
+  [[nodiscard]] constexpr auto num_corrupted_keys() const noexcept
+      -> std::size_t {
+    return num_corrupted;
   }
 
+  // Declared ahead of trees so that it outlives every node it handed out
+  [[no_unique_address]] typename Allocation::template Resource<NodeType>
+      node_resource;
   TreeList trees;
 
-  [[nodiscard]] constexpr auto MakeNodePtr(NodePtr&& x, NodePtr&& y) noexcept {
-    return std::make_unique<Node<Element, List, inverse_epsilon>>(
-        std::forward<NodePtr>(x), std::forward<NodePtr>(y));
+  [[nodiscard]] constexpr auto MakeNodePtr(Element&& elem) {
+    return node_resource.Make(std::forward<Element>(elem));
+  }
+
+  [[nodiscard]] constexpr auto MakeNodePtr(NodePtr&& x, NodePtr&& y) {
+    counters.OnCombine();
+    return node_resource.Make(std::forward<NodePtr>(x),
+                              std::forward<NodePtr>(y), counters);
   }
 
   [[nodiscard]] constexpr auto rank() const noexcept {
     return trees.back().rank();
   }
 
+  // Binary-counter link for rank-indexed roots: `tree` absorbs `that`
+  [[nodiscard]] constexpr auto Link() noexcept {
+    return [this](TreeType& tree, TreeType&& that, int /*rank*/) {
+      tree.root = MakeNodePtr(std::move(tree.root), std::move(that.root));
+    };
+  }
+
   constexpr void Combine(TreeListIt tree1, TreeListIt tree2) noexcept {
     tree1->root = MakeNodePtr(std::forward<NodePtr>(tree1->root),
                               std::forward<NodePtr>(tree2->root));
     trees.erase(tree2);
   }
 
+  // Restores a min root that dropped below half full: sift it from below,
+  // or drop its tree once it is an empty leaf
+  constexpr void Refill(TreeListIt min_tree) noexcept {
+    const auto& x = min_tree->root;
+    if (2 * std::ssize(x->elements) < x->size) {
+      if (not x->IsLeaf()) {
+        auto prune = Prune();
+        num_corrupted += x->Sift(counters, prune);
+        RefreshRoot(min_tree);
+      } else if (x->elements.empty()) {
+        EraseRoot(min_tree);
+      }
+    }
+  }
+
+  // After a root sift: only tombstones can have left the root empty
+  constexpr void RefreshRoot(TreeListIt tree) noexcept {
+    if (tree->root->elements.empty()) {
+      EraseRoot(tree);
+    } else {
+      UpdateRoot(tree);
+    }
+  }
+
+  // What sifts drop from the lists they pull up: the tombstones, taken off
+  // the counts they were part of
+  [[nodiscard]] constexpr auto Prune() noexcept {
+    if constexpr (Tombstones::tracked) {
+      return [this](List& elements, const Key& ckey, int& num_uncorrupted) {
+        num_dead -= EraseIf(elements, [&](const Element& element) {
+          if (not handles.Dead(element)) {
+            return false;
+          }
+          if (Order::Equivalent(Order::Key(element), ckey)) {
+            --num_uncorrupted;
+          } else {
+            --num_corrupted;
+          }
+          return true;
+        });
+      };
+    } else {
+      return policy::keep_all;
+    }
+  }
+
+  // Drops tombstones off the min root until Top() is live or nothing is left
+  constexpr void PurgeTop() noexcept {
+    while (not trees.empty()) {
+      const auto min_tree = MinTree();
+      if (not handles.Dead(min_tree->root->elements.back())) {
+        return;
+      }
+      num_corrupted -= min_tree->root->TakeBack().second ? 1 : 0;
+      --num_dead;
+      Refill(min_tree);
+    }
+  }
+
+  // Drops every tombstone in one pass over the lists. Roots left empty are
+  // refilled from below, or erased once nothing is left below them.
+  constexpr void Purge() noexcept {
+    auto prune = Prune();
+    for (auto tree = trees.begin(); tree != trees.end();) {
+      const auto next = std::next(tree);
+      auto& root = *tree->root;
+      root.PruneAll(prune);
+      if (root.elements.empty() and not root.IsLeaf()) {
+        num_corrupted += root.Sift(counters, prune);
+      }
+      if (root.elements.empty()) {
+        EraseRoot(tree);
+      }
+      tree = next;
+    }
+    if (not trees.empty()) {
+      UpdateSuffixMin(std::prev(trees.end()));
+    }
+  }
+
+  // The tree whose root holds the smallest ckey
+  [[nodiscard]] constexpr auto MinTree() noexcept -> TreeListIt {
+    if constexpr (scan_roots) {
+      return trees.At(root_keys.ArgMin());
+    } else {
+      return trees.front().min_ckey;
+    }
+  }
+
+  [[nodiscard]] constexpr auto MinRoot() const noexcept -> const TreeType& {
+    if constexpr (scan_roots) {
+      return *trees.At(root_keys.ArgMin());
+    } else {
+      return *trees.front().min_ckey;
+    }
+  }
+
+  // Only the ckey of this root changed: one key to rewrite when scanning
+  constexpr void UpdateRoot(TreeListIt tree) noexcept {
+    if constexpr (scan_roots) {
+      root_keys.Set(tree->rank(), tree->root->ckey);
+    } else {
+      UpdateSuffixMin(tree);
+    }
+  }
+
+  constexpr void EraseRoot(TreeListIt tree) noexcept {
+    if constexpr (scan_roots) {
+      root_keys.Clear(tree->rank());
+      trees.erase(tree);
+    } else if (tree != trees.begin()) {
+      const auto prev = std::prev(tree);
+      trees.erase(tree);
+      UpdateSuffixMin(prev);
+    } else {
+      trees.erase(tree);
+    }
+  }
+
+  // Roots up to and including it may have changed, been linked or erased
   constexpr void UpdateSuffixMin(TreeListIt it) noexcept {
+    counters.OnSuffixMinUpdate();
+    if constexpr (scan_roots) {
+      for (int rank = 0; rank <= it.rank() and rank < TreeList::max_rank;
+           ++rank) {
+        if (trees.Occupied(rank)) {
+          root_keys.Set(rank, trees.At(rank)->root->ckey);
+        } else {
+          root_keys.Clear(rank);
+        }
+      }
+      return;
+    }
     std::advance(it, 1);
     while (it != trees.begin()) {
       std::advance(it, -1);
       it->min_ckey = (std::next(it) == trees.end() or
-                      std::next(it)->min_ckey->root->ckey >= it->root->ckey)
+                      not Order::Less(std::next(it)->min_ckey->root->ckey,
+                                      it->root->ckey))
                          ? it
                          : std::next(it)->min_ckey;
     }
   }
 
+  // Live elements: tombstones still in the lists are not counted
   [[nodiscard]] auto size() const noexcept { return c_size; }
 
+  // Operation counts under a counting Stats policy, zeros under NoStats
+  [[nodiscard]] constexpr auto stats() const noexcept -> StatsSnapshot {
+    return counters.snapshot();
+  }
+
   double epsilon;
 
  private:
   size_t c_size;
+  std::size_t num_corrupted = 0;
+  [[no_unique_address]] Stats counters;
+  [[no_unique_address]] std::conditional_t<scan_roots, RootKeys<Key, Order>,
+                                           detail::NoRootKeys>
+      root_keys;
+  [[no_unique_address]] Tombstones handles;
+  std::size_t num_dead = 0;  // tombstones still in the lists
+
+  // Meld without its guard, for InsertRange's bursts: their entries carry no
+  // handles, so a tracked heap can take them in
+  constexpr void Absorb(SoftHeap&& P) noexcept
+    requires Roots::rank_indexed
+  {
+    counters.OnMeld();
+    counters.Merge(P.counters);
+    num_corrupted += std::exchange(P.num_corrupted, 0);
+    node_resource.Adopt(std::move(P.node_resource));
+    c_size += std::exchange(P.c_size, 0);
+    UpdateSuffixMin(trees.Merge(std::move(P.trees), Link()));
+  }
+
+  constexpr void Absorb(SoftHeap&& P) noexcept {
+    counters.OnMeld();
+    counters.Merge(P.counters);
+    num_corrupted += std::exchange(P.num_corrupted, 0);
+    node_resource.Adopt(std::move(P.node_resource));
+    if (P.trees.empty()) {
+      return;
+    }
+    if (std::ssize(trees) != 0 && P.rank() > rank()) {
+      trees.swap(P.trees);
+    }
+    c_size += std::exchange(P.c_size, 0);
+    const auto p_rank = P.rank();
+    trees.merge(P.trees);
+
+    // Binary addition over the rank-sorted list. With three trees of one
+    // rank (a carry plus one from each heap) the later two are linked so the
+    // list stays sorted. Past p_rank without a carry, the trees and their
+    // suffix minima are this heap's own and need no update.
+    for (auto tree = trees.begin(); std::next(tree) != trees.end();) {
+      const auto next = std::next(tree);
+      if (tree->rank() != next->rank()) {
+        if (tree->rank() > p_rank) {
+          UpdateSuffixMin(tree);
+          return;
+        }
+        tree = next;
+      } else if (std::next(next) != trees.end() and
+                 std::next(next)->rank() == tree->rank()) {
+        tree = next;
+      } else {
+        Combine(tree, next);
+      }
+    }
+    UpdateSuffixMin(std::prev(trees.end()));
+  }
+
+  constexpr void Swap(SoftHeap& that) noexcept {
+    using std::swap;
+    swap(epsilon, that.epsilon);
+    swap(node_resource, that.node_resource);
+    swap(trees, that.trees);
+    swap(c_size, that.c_size);
+    swap(num_corrupted, that.num_corrupted);
+    swap(counters, that.counters);
+    swap(root_keys, that.root_keys);
+    swap(handles, that.handles);
+    swap(num_dead, that.num_dead);
+  }
 };
 
 }  // namespace soft_heap
@@ -0,0 +1,110 @@
+#pragma once
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+
+namespace soft_heap {
+
+// What a heap has done since it was built, summed over every heap melded
+// into it. Read through the heap's stats().
+struct StatsSnapshot {
+  std::uint64_t inserts = 0;
+  std::uint64_t extracts = 0;
+  std::uint64_t melds = 0;
+  std::uint64_t combines = 0;        // two trees linked under a new root
+  std::uint64_t sifts = 0;           // a node refilled from its smaller child
+  std::uint64_t elements_moved = 0;  // by those sifts
+  std::uint64_t leaf_deletions = 0;  // leaves a sift emptied and freed
+  std::uint64_t suffix_min_updates = 0;  // root-min refreshes after a change
+  std::uint64_t compactions = 0;  // sparse flat trees relinked from leaves
+
+  constexpr auto operator+=(const StatsSnapshot& that) noexcept
+      -> StatsSnapshot& {
+    inserts += that.inserts;
+    extracts += that.extracts;
+    melds += that.melds;
+    combines += that.combines;
+    sifts += that.sifts;
+    elements_moved += that.elements_moved;
+    leaf_deletions += that.leaf_deletions;
+    suffix_min_updates += that.suffix_min_updates;
+    compactions += that.compactions;
+    return *this;
+  }
+
+  friend constexpr auto operator==(const StatsSnapshot&,
+                                   const StatsSnapshot&) noexcept
+      -> bool = default;
+};
+
+namespace policy {
+
+// Default: every hook is an empty static function and the heap stores the
+// policy as an empty member, so counting compiles away entirely.
+struct NoStats {
+  static constexpr void OnInsert() noexcept {}
+  static constexpr void OnExtract() noexcept {}
+  static constexpr void OnMeld() noexcept {}
+  static constexpr void OnCombine() noexcept {}
+  static constexpr void OnSift(std::size_t /*moved*/) noexcept {}
+  static constexpr void OnLeafDeletion() noexcept {}
+  static constexpr void OnSuffixMinUpdate() noexcept {}
+  static constexpr void OnCompaction() noexcept {}
+  static constexpr void Merge(const NoStats& /*that*/) noexcept {}
+
+  [[nodiscard]] static constexpr auto snapshot() noexcept -> StatsSnapshot {
+    return {};
+  }
+};
+
+// What Node and FlatTree sift with when no heap passes its own stats
+inline constexpr auto no_stats = NoStats();
+
+// Plain per-heap counters. Not atomic: a heap is only ever modified by one
+// thread at a time.
+class CountingStats {
+ public:
+  constexpr void OnInsert() noexcept { ++counts.inserts; }
+  constexpr void OnExtract() noexcept { ++counts.extracts; }
+  constexpr void OnMeld() noexcept { ++counts.melds; }
+  constexpr void OnCombine() noexcept { ++counts.combines; }
+
+  constexpr void OnSift(std::size_t moved) noexcept {
+    ++counts.sifts;
+    counts.elements_moved += moved;
+  }
+
+  constexpr void OnLeafDeletion() noexcept { ++counts.leaf_deletions; }
+  constexpr void OnSuffixMinUpdate() noexcept { ++counts.suffix_min_updates; }
+  constexpr void OnCompaction() noexcept { ++counts.compactions; }
+
+  // Takes over the history of a heap melded into this one
+  constexpr void Merge(const CountingStats& that) noexcept {
+    counts += that.counts;
+  }
+
+  [[nodiscard]] constexpr auto snapshot() const noexcept -> StatsSnapshot {
+    return counts;
+  }
+
+ private:
+  StatsSnapshot counts;
+};
+
+template <class Stats>
+concept OperationStats = requires(Stats& stats, const Stats& that) {
+  stats.OnInsert();
+  stats.OnExtract();
+  stats.OnMeld();
+  stats.OnCombine();
+  stats.OnSift(std::size_t{});
+  stats.OnLeafDeletion();
+  stats.OnSuffixMinUpdate();
+  stats.OnCompaction();
+  stats.Merge(that);
+  { that.snapshot() } -> std::same_as<StatsSnapshot>;
+};
+
+}  // namespace policy
+
+}  // namespace soft_heap
@@ -0,0 +1,116 @@
+#pragma once
+#include <compare>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace soft_heap {
+
+// Names one inserted element for Delete and DecreaseKey. A handle goes stale
+// once its element has left the heap; stale handles are ignored.
+struct Handle {
+  std::uint32_t slot;
+  std::uint32_t generation;
+
+  [[nodiscard]] friend constexpr auto operator==(const Handle&,
+                                                 const Handle&) noexcept
+      -> bool = default;
+};
+
+// A list entry of a heap that hands out handles: the element with the slot
+// and generation it was inserted under. Entries that come in through the
+// bulk constructor or InsertRange get no handle and never die.
+template <class Element>
+struct Tagged {
+  static constexpr auto untracked = std::numeric_limits<std::uint32_t>::max();
+
+  constexpr Tagged(Element element) noexcept  // NOLINT(google-explicit-*)
+      : element(std::move(element)) {}
+
+  Element element;
+  std::uint32_t slot = untracked;
+  std::uint32_t generation = 0;
+
+  constexpr auto operator<=>(const Tagged&) const noexcept = default;
+};
+
+namespace policy {
+
+// Default: nothing is ever deleted, Insert returns nothing and every
+// tombstone check compiles away
+struct NoTombstones {
+  static constexpr bool tracked = false;
+};
+
+// Lazy deletion for heaps of Tagged entries. Each live handle owns a slot
+// holding the generation its entry was tagged with. Delete bumps it, which
+// turns the entry into a tombstone wherever it sits, and frees the slot at
+// once; the heap drops the entry when a sift or the top reaches it.
+class GenerationTombstones {
+ public:
+  static constexpr bool tracked = true;
+
+  // Tags entry with a free slot and returns the handle naming it
+  template <class Element>
+  constexpr auto Track(Tagged<Element>& entry) -> Handle {
+    if (free_slots.empty()) {
+      entry.slot = static_cast<std::uint32_t>(generations.size());
+      generations.push_back(0);
+    } else {
+      entry.slot = free_slots.back();
+      free_slots.pop_back();
+    }
+    entry.generation = generations[entry.slot];
+    return {entry.slot, entry.generation};
+  }
+
+  template <class Element>
+  [[nodiscard]] constexpr auto Dead(const Tagged<Element>& entry) const noexcept
+      -> bool {
+    return entry.slot != entry.untracked and
+           generations[entry.slot] != entry.generation;
+  }
+
+  [[nodiscard]] constexpr auto Live(Handle handle) const noexcept -> bool {
+    return handle.slot < generations.size() and
+           generations[handle.slot] == handle.generation;
+  }
+
+  // Stales the handle and frees its slot, whether its entry was extracted
+  // or is left behind as a tombstone
+  constexpr void Release(Handle handle) noexcept {
+    ++generations[handle.slot];
+    free_slots.push_back(handle.slot);
+  }
+
+  template <class Element>
+  constexpr void Release(const Tagged<Element>& entry) noexcept {
+    if (entry.slot != entry.untracked) {
+      Release(Handle{entry.slot, entry.generation});
+    }
+  }
+
+ private:
+  std::vector<std::uint32_t> generations;
+  std::vector<std::uint32_t> free_slots;
+};
+
+template <class Tombstones>
+concept TombstoneTracking = requires {
+  { Tombstones::tracked } -> std::convertible_to<bool>;
+};
+
+// What sifts drop from a list they pull up when the heap keeps no
+// tombstones: nothing
+struct KeepAll {
+  constexpr void operator()(const auto& /*elements*/, const auto& /*ckey*/,
+                            const int& /*num_uncorrupted*/) const noexcept {}
+};
+
+inline constexpr auto keep_all = KeepAll();
+
+}  // namespace policy
+
+}  // namespace soft_heap
@@ -7,27 +7,37 @@
 #include <type_traits>
 
 #include "node.hpp"
+#include "order.hpp"
 #include "policies.hpp"
+#include "ranked_trees.hpp"
 
 namespace soft_heap {
 
 template <policy::TotalOrdered Element, policy::TotalOrderedContainer List,
-          int inverse_epsilon>
+          int inverse_epsilon,
+          policy::NodeAllocation Allocation = policy::HeapAllocation,
+          policy::RootContainer Roots = policy::LinkedRoots,
+          policy::ElementOrder<Element> Order = policy::NaturalOrder>
 class Tree {
  public:
-  using NodePtr = std::unique_ptr<Node<Element, List, inverse_epsilon>>;
+  using NodeType = Node<Element, List, inverse_epsilon, Allocation, Order>;
+  using NodePtr = typename NodeType::NodePtr;
   // using TreeList = std::set<Tree<Element, List>>;
-  using TreeList = std::list<Tree>;
+  using TreeList = typename Roots::template Container<Tree>;
   using TreeListIt = typename TreeList::iterator;
 
   [[nodiscard]] constexpr auto MakeNodePtr(Element&& elem) const noexcept {
-    return std::make_unique<Node<Element, List, inverse_epsilon>>(
-        std::forward<Element>(elem));
+    return std::make_unique<NodeType>(std::forward<Element>(elem));
   }
 
+  // Pooled nodes need the owning heap's resource, see NodePtr overload
   constexpr explicit Tree(Element&& element) noexcept
+    requires std::same_as<Allocation, policy::HeapAllocation>
       : root(MakeNodePtr(std::forward<Element>(element))) {}
 
+  constexpr explicit Tree(NodePtr&& node) noexcept
+      : root(std::forward<NodePtr>(node)) {}
+
   // constexpr explicit Tree(Element&& element) noexcept {
   //   node_heap.emplace_back(std::forward<Element>(element));
   // }
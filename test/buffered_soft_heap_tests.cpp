@@ -0,0 +1,102 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "buffered_soft_heap.hpp"
+#include "common.hpp"
+
+namespace soft_heap::test {
+
+// NOLINTBEGIN(modernize-use-trailing-return-type)
+
+using Buffered = BufferedSoftHeap<int, 1000>;
+
+TEST(BufferedSoftHeap, PublishesWhenTheBufferFills) {
+  auto heap = Buffered(4);
+  auto producer = heap.MakeProducer();
+  for (int x : {5, 3, 7}) {
+    producer.Insert(x);
+  }
+  EXPECT_EQ(producer.buffered(), 3);
+  EXPECT_EQ(heap.ExtractMin(), std::nullopt);
+  producer.Insert(1);
+  EXPECT_EQ(producer.buffered(), 0);
+  EXPECT_EQ(heap.size(), 4);
+  EXPECT_EQ(heap.ExtractMin(), 1);
+  EXPECT_EQ(heap.ExtractMin(), 3);
+}
+
+TEST(BufferedSoftHeap, RequestFlushReachesTheNextInsert) {
+  auto heap = Buffered(100);
+  auto producer = heap.MakeProducer();
+  producer.Insert(2);
+  heap.RequestFlush();
+  EXPECT_EQ(heap.size(), 0);
+  producer.Insert(1);
+  EXPECT_EQ(heap.size(), 2);
+  producer.Insert(0);  // the request was served once
+  EXPECT_EQ(heap.size(), 2);
+}
+
+TEST(BufferedSoftHeap, ProducerFlushesOnDestructionAndMove) {
+  auto heap = Buffered(100);
+  {
+    auto producer = heap.MakeProducer();
+    producer.Insert(4);
+    auto moved = std::move(producer);
+    moved.Insert(6);
+    producer = heap.MakeProducer();
+    producer.Insert(9);
+    moved = std::move(producer);  // flushes 4 and 6 first
+    EXPECT_EQ(heap.size(), 2);
+  }
+  EXPECT_EQ(heap.size(), 3);
+  EXPECT_EQ(heap.ExtractMin(), 4);
+  EXPECT_EQ(heap.ExtractMin(), 6);
+  EXPECT_EQ(heap.ExtractMin(), 9);
+}
+
+TEST(BufferedSoftHeap, IdleProducerKeepsItsBufferUntilFlush) {
+  auto heap = Buffered(100);
+  auto producer = heap.MakeProducer();
+  producer.Insert(5);
+  heap.RequestFlush();  // only a hint until the producer inserts again
+  EXPECT_EQ(heap.size(), 0);
+  EXPECT_EQ(heap.ExtractMin(), std::nullopt);
+  producer.Flush();
+  EXPECT_EQ(heap.ExtractMin(), 5);
+
+  auto moved = std::move(producer);
+  producer.Flush();  // detached: nothing to publish, nowhere to publish it
+  EXPECT_EQ(producer.buffered(), 0);
+}
+
+TEST(BufferedSoftHeap, ConcurrentProducers) {
+  constexpr int num_threads = 8;
+  constexpr int per_thread = 5000;
+  auto heap = Buffered(64);
+  auto threads = std::vector<std::thread>();
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&heap, t] {
+      auto producer = heap.MakeProducer();
+      for (int i = 0; i < per_thread; ++i) {
+        producer.Insert(i * num_threads + t);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(heap.size(), num_threads * per_thread);
+  for (int i = 0; i < num_threads * per_thread; ++i) {
+    EXPECT_EQ(heap.ExtractMin(), i);
+  }
+}
+
+// NOLINTEND(modernize-use-trailing-return-type)
+
+}  // namespace soft_heap::test
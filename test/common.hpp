@@ -13,26 +13,24 @@
 #include "node.hpp"
 #include "policies.hpp"
 #include "tree.hpp"
+#include "workload.hpp"
 
 namespace soft_heap::test {
 
 namespace detail {
 
-[[nodiscard]] inline auto generate_rand(int n) noexcept {
-  auto v = std::vector<int>(n);
-  std::iota(v.begin(), v.end(), 1);  // 1,2,...,size-1
-  std::shuffle(v.begin(), v.end(), std::mt19937(std::random_device()()));
-  return v;
-}
+using workload::generate_rand;
 
 }  // namespace detail
 
 template <policy::TotalOrdered Element = int,
           policy::TotalOrderedContainer List = std::vector<Element>,
-          int inverse_epsilon>
+          int inverse_epsilon, class Allocation, class Order, class Deleter>
 [[maybe_unused]] static void EXPECT_NODE_EQ(
-    const std::unique_ptr<Node<Element, List, inverse_epsilon>>& node,
-    const Node<Element, List, inverse_epsilon>& expect) {
+    const std::unique_ptr<
+        Node<Element, List, inverse_epsilon, Allocation, Order>, Deleter>&
+        node,
+    const Node<Element, List, inverse_epsilon, Allocation, Order>& expect) {
   ASSERT_NE(node, nullptr)
       << "\033[1;31mError: Node passed in as nullptr!\033[0m";
   EXPECT_EQ(node->rank, expect.rank);
@@ -48,10 +46,10 @@ template <policy::TotalOrdered Element = int,
 
 template <policy::TotalOrdered Element = int,
           policy::TotalOrderedContainer List = std::vector<Element>,
-          int inverse_epsilon>
+          int inverse_epsilon, class Order>
 [[maybe_unused]] static void EXPECT_NODE_EQ(
-    const FlatNode<Element, List, inverse_epsilon>& node,
-    const FlatNode<Element, List, inverse_epsilon>& expect) {
+    const FlatNode<Element, List, inverse_epsilon, Order>& node,
+    const FlatNode<Element, List, inverse_epsilon, Order>& expect) {
   EXPECT_EQ(node.rank, expect.rank);
   EXPECT_EQ(node.size, expect.size);
   EXPECT_EQ(node.elements.size(), expect.elements.size());
@@ -0,0 +1,91 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "common.hpp"
+#include "concurrent_soft_heap.hpp"
+
+namespace soft_heap::test {
+
+// NOLINTBEGIN(modernize-use-trailing-return-type)
+
+TEST(ConcurrentSoftHeap, Shards) {
+  EXPECT_EQ(ConcurrentSoftHeap<int>(4).num_shards(), 8);
+  EXPECT_EQ(ConcurrentSoftHeap<int>(4, 4).num_shards(), 16);
+  EXPECT_EQ(ConcurrentSoftHeap<int>(0).num_shards(), 2);
+}
+
+TEST(ConcurrentSoftHeap, DrainsEveryElement) {
+  auto rand = detail::generate_rand(3000);
+  auto heap = ConcurrentSoftHeap<int>(4);
+  EXPECT_EQ(heap.ExtractMin(), std::nullopt);
+  for (auto x : rand) {
+    heap.Insert(x);
+  }
+  EXPECT_EQ(heap.size(), 3000);
+  auto extracted = std::vector<int>();
+  while (auto x = heap.ExtractMin()) {
+    extracted.push_back(*x);
+  }
+  EXPECT_TRUE(heap.empty());
+  std::sort(extracted.begin(), extracted.end());
+  std::sort(rand.begin(), rand.end());
+  EXPECT_EQ(extracted, rand);
+}
+
+// Two-choice sampling keeps the extraction order close to sorted
+TEST(ConcurrentSoftHeap, RankErrorStaysSmall) {
+  constexpr int n = 4000;
+  auto rand = detail::generate_rand(n);
+  auto heap = ConcurrentSoftHeap<int, 1000>(2);
+  for (auto x : rand) {
+    heap.Insert(x);
+  }
+  auto removed = std::vector<bool>(n + 1);
+  auto total_error = 0L;
+  while (auto x = heap.ExtractMin()) {
+    total_error += std::count(removed.begin() + 1, removed.begin() + *x, false);
+    removed[*x] = true;
+  }
+  EXPECT_LT(static_cast<double>(total_error) / n, 8.0);
+}
+
+TEST(ConcurrentSoftHeap, ConcurrentProducersAndConsumers) {
+  constexpr int num_threads = 8;
+  constexpr int per_thread = 5000;
+  auto heap = ConcurrentSoftHeap<int>(num_threads);
+  auto seen = std::vector<std::atomic<int>>(num_threads * per_thread);
+  auto consumed = std::atomic<int>(0);
+  auto threads = std::vector<std::thread>();
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < per_thread; ++i) {
+        heap.Insert(t * per_thread + i);
+        if (i % 2 == 1) {
+          if (auto x = heap.ExtractMin()) {
+            seen[*x].fetch_add(1);
+            consumed.fetch_add(1);
+          }
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  while (auto x = heap.ExtractMin()) {
+    seen[*x].fetch_add(1);
+    consumed.fetch_add(1);
+  }
+  EXPECT_EQ(consumed.load(), num_threads * per_thread);
+  EXPECT_TRUE(std::all_of(seen.begin(), seen.end(),
+                          [](const auto& count) { return count == 1; }));
+}
+
+// NOLINTEND(modernize-use-trailing-return-type)
+
+}  // namespace soft_heap::test
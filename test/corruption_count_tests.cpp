@@ -0,0 +1,122 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "common.hpp"
+#include "flat_soft_heap.hpp"
+#include "soft_heap.hpp"
+
+namespace soft_heap::test {
+
+// NOLINTBEGIN(modernize-use-trailing-return-type)
+
+namespace detail {
+
+// The O(n) count the incremental one replaces
+template <class Heap>
+auto WalkCorrupted(Heap& heap) -> std::size_t {
+  auto num = std::size_t{0};
+  for (auto& tree : heap.trees) {
+    num += static_cast<std::size_t>(tree.num_corrupted_keys());
+  }
+  return num;
+}
+
+template <class Heap>
+auto WalkFlatCorrupted(Heap& heap) -> std::size_t {
+  auto num = std::size_t{0};
+  for (auto& tree : heap.trees) {
+    const auto& nodes = tree.node_heap;
+    for (std::ptrdiff_t idx = 0; idx < nodes.ssize(); ++idx) {
+      if (not tree.Vacant(idx)) {
+        num += std::ranges::count_if(nodes.elements(idx), [&](int x) {
+          return x < nodes.ckey(idx);
+        });
+      }
+    }
+  }
+  return num;
+}
+
+// Interleaves bulk builds, inserts, melds, single and batched extracts and
+// checks the live count against walk(heap) along the way. Keys mod `range`
+// give many ties.
+template <class Heap>
+void ExpectCountMatchesWalk(auto walk, int range) {
+  auto gen = std::mt19937(range);
+  auto keys = generate_rand(4000);
+  for (auto& x : keys) {
+    x %= range;
+  }
+  auto heap = Heap(keys.begin(), std::next(keys.begin(), 1000));
+  auto out = std::vector<int>(64);
+  auto peak = std::size_t{0};
+  for (int step = 0; step < 400; ++step) {
+    switch (gen() % 4) {
+      case 0:
+        heap.Insert(static_cast<int>(gen() % range));
+        break;
+      case 1: {
+        const auto first = std::next(keys.begin(), gen() % 3000);
+        heap.Meld(Heap(first, std::next(first, gen() % 64)));
+        break;
+      }
+      case 2:
+        heap.ExtractMinBatch(std::span(out));
+        break;
+      default:
+        if (heap.size() != 0) {
+          (void)heap.ExtractMin();
+        }
+    }
+    EXPECT_EQ(heap.num_corrupted_keys(), walk(heap));
+    peak = std::max(peak, heap.num_corrupted_keys());
+  }
+  EXPECT_GT(peak, 0);
+  while (heap.size() != 0) {
+    (void)heap.ExtractMinC();
+    EXPECT_EQ(heap.num_corrupted_keys(), walk(heap));
+  }
+}
+
+}  // namespace detail
+
+TEST(CorruptionCount, SoftHeap) {
+  using Heap = SoftHeap<int, std::vector<int>, 2>;
+  const auto walk = [](Heap& heap) { return detail::WalkCorrupted(heap); };
+  detail::ExpectCountMatchesWalk<Heap>(walk, 1 << 30);
+  detail::ExpectCountMatchesWalk<Heap>(walk, 7);
+}
+
+TEST(CorruptionCount, SoftHeapRankedRoots) {
+  using Heap = SoftHeap<int, InlineList<int>, 2, policy::PoolAllocation<>,
+                        policy::RankedRoots>;
+  const auto walk = [](Heap& heap) { return detail::WalkCorrupted(heap); };
+  detail::ExpectCountMatchesWalk<Heap>(walk, 1 << 30);
+  detail::ExpectCountMatchesWalk<Heap>(walk, 7);
+}
+
+TEST(CorruptionCount, FlatSoftHeap) {
+  using Heap = FlatSoftHeap<int, std::vector<int>, 2>;
+  const auto walk = [](Heap& heap) { return detail::WalkFlatCorrupted(heap); };
+  detail::ExpectCountMatchesWalk<Heap>(walk, 1 << 30);
+  detail::ExpectCountMatchesWalk<Heap>(walk, 7);
+}
+
+TEST(CorruptionCount, FlatSoftHeapSplitArrays) {
+  using Heap = FlatSoftHeap<int, InlineList<int>, 2, policy::RankedRoots,
+                            policy::NaturalOrder, policy::SplitArrayLayout>;
+  const auto walk = [](Heap& heap) { return detail::WalkFlatCorrupted(heap); };
+  detail::ExpectCountMatchesWalk<Heap>(walk, 1 << 30);
+  detail::ExpectCountMatchesWalk<Heap>(walk, 7);
+}
+
+// NOLINTEND(modernize-use-trailing-return-type)
+
+}  // namespace soft_heap::test
@@ -1,14 +1,21 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
 #include <fstream>
 #include <list>
+#include <set>
+#include <utility>
 #include <vector>
 
 #include "common.hpp"
 #include "flat_node.hpp"
 #include "flat_soft_heap.hpp"
 #include "flat_tree.hpp"
+#include "inline_list.hpp"
+#include "ranked_trees.hpp"
 #include "soft_heap.hpp"
 // NOLINTBEGIN(modernize-use-trailing-return-type)
 
@@ -86,6 +93,349 @@ TEST(FlatSoftHeap, Extract) {
 //   fout << std::endl;
 // }
 
+TEST(FlatSoftHeap, BulkConstructMatchesInsert) {
+  auto rand = detail::generate_rand(2000);
+  auto bulk = FlatSoftHeap<int, vector<int>, 4>(rand.begin(), rand.end());
+  auto inserted = FlatSoftHeap<int, vector<int>, 4>(std::move(rand[0]));
+  for (int i = 1; i < 2000; ++i) {
+    inserted.Insert(std::move(rand[i]));
+  }
+  ASSERT_EQ(bulk.trees.size(), inserted.trees.size());
+  EXPECT_EQ(bulk.size(), inserted.size());
+  for ([[maybe_unused]] auto&& x : rand) {
+    EXPECT_EQ(bulk.ExtractMin(), inserted.ExtractMin());
+  }
+}
+
+TEST(FlatSoftHeap, TopPeeksNextExtractMin) {
+  auto rand = detail::generate_rand(2000);
+  auto soft_heap = FlatSoftHeap<int, vector<int>, 4>(rand.begin(), rand.end());
+  for ([[maybe_unused]] auto&& x : rand) {
+    const auto top = soft_heap.Top();
+    EXPECT_LE(top, soft_heap.TopCKey());
+    EXPECT_EQ(top, soft_heap.ExtractMin());
+  }
+  EXPECT_EQ(soft_heap.TryExtractMinIf([](int) { return true; }), std::nullopt);
+}
+
+TEST(FlatSoftHeap, ExtractMinBatch) {
+  auto rand = detail::generate_rand(3000);
+  auto soft_heap = FlatSoftHeap<int, vector<int>, 4>(rand.begin(), rand.end());
+  auto extracted = vector<int>();
+  while (soft_heap.size() != 0) {
+    soft_heap.ExtractMinBatch(std::back_inserter(extracted), 100);
+  }
+  EXPECT_TRUE(soft_heap.trees.empty());
+  std::sort(rand.begin(), rand.end());
+  std::sort(extracted.begin(), extracted.end());
+  EXPECT_EQ(extracted, rand);
+}
+
+TEST(FlatSoftHeap, InsertRange) {
+  auto rand = detail::generate_rand(3000);
+  auto mid = std::next(rand.begin(), 1000);
+  auto soft_heap = FlatSoftHeap<int, vector<int>, 4>();
+  soft_heap.InsertRange(rand.begin(), mid);
+  soft_heap.InsertRange(mid, std::next(mid, 1500));
+  soft_heap.InsertRange(std::next(mid, 1500), rand.end());
+  EXPECT_EQ(3000, soft_heap.size());
+  std::set<int> extracted_elems;
+  for ([[maybe_unused]] auto&& x : rand) {
+    EXPECT_TRUE(extracted_elems.insert(soft_heap.ExtractMin()).second);
+  }
+  EXPECT_EQ(0, soft_heap.size());
+}
+
+TEST(FlatSoftHeap, SplitLayoutMatchesNodeArray) {
+  using Split = FlatSoftHeap<int, vector<int>, 4, policy::LinkedRoots,
+                             policy::NaturalOrder, policy::SplitArrayLayout>;
+  auto rand = detail::generate_rand(3000);
+  auto mid = std::next(rand.begin(), 1234);
+  auto node_array = FlatSoftHeap<int, vector<int>, 4>(rand.begin(), mid);
+  auto split = Split(rand.begin(), mid);
+  for (auto it = mid; it != rand.end(); ++it) {
+    node_array.Insert(*it);
+    split.Insert(*it);
+  }
+  EXPECT_EQ(node_array.TopCKey(), split.TopCKey());
+  for ([[maybe_unused]] auto&& x : rand) {
+    EXPECT_EQ(node_array.ExtractMin(), split.ExtractMin());
+  }
+  EXPECT_EQ(0, split.size());
+}
+
+TEST(FlatTree, SplitArraysKeepSlotsParallel) {
+  using Nodes = policy::SplitArrayLayout::Storage<int, vector<int>, 8,
+                                                  policy::NaturalOrder>;
+  auto that = Nodes();
+  that.emplace_back(3);
+  that.emplace_back(1);
+  that.meta(1).size = 2;
+  auto nodes = Nodes();
+  nodes.emplace_back(1, 4);
+  nodes.append(that, 1, 2);
+  EXPECT_EQ(nodes.ssize(), 2);
+  EXPECT_TRUE(nodes.elements(0).empty());
+  EXPECT_EQ(nodes.meta(0).rank, 1);
+  EXPECT_EQ(nodes.ckey(1), 1);
+  EXPECT_EQ(nodes.meta(1).size, 2);
+  EXPECT_THAT(nodes.elements(1), ::testing::ElementsAre(1));
+}
+
+TEST(FlatTree, CombineKeepsPostOrder) {
+  auto tree = T(4);
+  tree.Combine(T(2), 1);
+  auto that = T(3);
+  that.Combine(T(1), 1);
+  tree.Combine(std::move(that), 2);
+  ASSERT_EQ(tree.node_heap.ssize(), 7);
+  EXPECT_EQ(tree.root(), 6);
+  EXPECT_EQ(tree.rank(), 2);
+  // Each new root pulled its smaller child's element up, vacating leaves
+  EXPECT_EQ(tree.node_heap.ckey(6), 1);
+  EXPECT_EQ(tree.node_heap.ckey(5), 3);
+  EXPECT_EQ(tree.node_heap.ckey(2), 2);
+  EXPECT_EQ(tree.node_heap.ckey(0), 4);
+  EXPECT_TRUE(tree.Vacant(1));
+  EXPECT_TRUE(tree.Vacant(3));
+  EXPECT_TRUE(tree.Vacant(4));
+  EXPECT_FALSE(tree.IsLeaf(2));
+  EXPECT_TRUE(tree.IsLeaf(5));
+}
+
+TEST(FlatTree, CombineShiftsOccupancyAcrossWords) {
+  auto rand = detail::generate_rand(1 << 8);
+  auto trees = RankedTrees<T>();
+  for (auto x : rand) {
+    trees.Carry(0, T(std::move(x)), [](T& tree, T&& that, int rank) {
+      tree.Combine(std::move(that), rank);
+    });
+  }
+  auto& tree = trees.front();
+  ASSERT_EQ(tree.rank(), 8);
+  auto live = 0;
+  for (std::ptrdiff_t idx = 0; idx < tree.node_heap.ssize(); ++idx) {
+    live += tree.Vacant(idx) ? 0 : 1;
+    if (not tree.Vacant(idx)) {
+      EXPECT_FALSE(tree.node_heap.elements(idx).empty());
+    }
+  }
+  EXPECT_EQ(live, 1 << 8);  // every sift vacated exactly one leaf
+}
+
+namespace detail {
+
+// One tree of rank log2(n) linked from n singletons
+template <class Tree>
+[[nodiscard]] auto LinkAll(int n) -> Tree {
+  auto trees = RankedTrees<Tree>();
+  for (auto x : generate_rand(n)) {
+    trees.Carry(0, Tree(std::move(x)), [](Tree& tree, Tree&& that, int rank) {
+      tree.Combine(std::move(that), rank);
+    });
+  }
+  return std::move(trees.front());
+}
+
+template <class Tree>
+[[nodiscard]] auto HolesReleased(const Tree& tree) {
+  for (std::ptrdiff_t idx = 0; idx < tree.node_heap.ssize(); ++idx) {
+    if (tree.Vacant(idx) and tree.node_heap.elements(idx).capacity() != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace detail
+
+TEST(FlatTree, VacatedSlotsReleaseTheirLists) {
+  using Split = FlatTree<int, vector<int>, 2, policy::LinkedRoots,
+                         policy::NaturalOrder, policy::SplitArrayLayout>;
+  auto tree = detail::LinkAll<T>(1 << 10);
+  auto split = detail::LinkAll<Split>(1 << 10);
+  EXPECT_TRUE(detail::HolesReleased(tree));
+  EXPECT_TRUE(detail::HolesReleased(split));
+  // empty and refill the roots until only they are left
+  while (not tree.IsLeaf(tree.root())) {
+    tree.node_heap.elements(tree.root()).clear();
+    tree.Sift();
+    ASSERT_TRUE(detail::HolesReleased(tree));
+  }
+  while (not split.IsLeaf(split.root())) {
+    split.node_heap.elements(split.root()).clear();
+    split.Sift();
+    ASSERT_TRUE(detail::HolesReleased(split));
+  }
+}
+
+namespace detail {
+
+// Slots of every tree against the live elements, through a half drain, a
+// refill and a full drain. Combine sizes each array exactly, so the slots
+// reserved, and with them the bytes per element, follow the same bound.
+template <class Heap>
+void ExpectSlotsTrackSize() {
+  auto rand = generate_rand(1 << 14);
+  auto heap = Heap(rand.begin(), rand.end());
+  const auto slots = [&] {
+    auto total = std::ptrdiff_t{0};
+    for (const auto& tree : heap.trees) {
+      total += tree.node_heap.ssize();
+    }
+    return total;
+  };
+  const auto reserved = [&] {
+    auto total = std::ptrdiff_t{0};
+    for (const auto& tree : heap.trees) {
+      total += tree.node_heap.capacity();
+    }
+    return total;
+  };
+  // a sparse tree is relinked as soon as a sift leaves it under a quarter
+  // full, and every live node but the roots holds an element
+  const auto bounded = [&] {
+    return reserved() <= 4 * std::ssize(heap.trees) +
+                             4 * static_cast<std::ptrdiff_t>(heap.size());
+  };
+  EXPECT_EQ(reserved(), slots());
+  EXPECT_LT(reserved(), 2 * std::ssize(rand));
+  for (std::size_t i = 0; i < rand.size() / 2; ++i) {
+    static_cast<void>(heap.ExtractMin());
+    ASSERT_TRUE(bounded());
+  }
+  EXPECT_LT(reserved(), 2 * std::ssize(rand));
+  heap.InsertRange(rand.begin(), std::next(rand.begin(), rand.size() / 2));
+  EXPECT_EQ(reserved(), slots());
+  EXPECT_LT(reserved(), 3 * std::ssize(rand));
+  while (heap.size() != 0) {
+    static_cast<void>(heap.ExtractMin());
+    ASSERT_TRUE(bounded());
+  }
+}
+
+}  // namespace detail
+
+TEST(FlatSoftHeap, CompactionBoundsSlotsBySize) {
+  detail::ExpectSlotsTrackSize<FlatSoftHeap<int, vector<int>, 4>>();
+  detail::ExpectSlotsTrackSize<
+      FlatSoftHeap<int, vector<int>, 4, policy::RankedRoots,
+                   policy::NaturalOrder, policy::SplitArrayLayout,
+                   policy::ScanMinRoots>>();
+}
+
+TEST(FlatSoftHeap, SignedTimestampsAroundZero) {
+  auto stamps = std::vector<std::int64_t>();
+  for (auto x : detail::generate_rand(3000)) {
+    stamps.push_back((std::int64_t{x} - 1500) << 33);  // includes 0
+  }
+  auto soft_heap = FlatSoftHeap<std::int64_t, std::vector<std::int64_t>, 4>(
+      stamps.begin(), stamps.end());
+  auto extracted = std::vector<std::int64_t>();
+  while (soft_heap.size() != 0) {
+    extracted.push_back(soft_heap.ExtractMin());
+  }
+  std::sort(stamps.begin(), stamps.end());
+  std::sort(extracted.begin(), extracted.end());
+  EXPECT_EQ(extracted, stamps);
+}
+
+TEST(FlatSoftHeap, CompositeKeys) {
+  using Key = std::pair<int, int>;
+  auto keys = std::vector<Key>();
+  for (auto x : detail::generate_rand(2000)) {
+    keys.emplace_back(x % 3 - 1, -x);  // repeated and default-valued firsts
+  }
+  auto soft_heap = FlatSoftHeap<Key, std::vector<Key>, 1000>(keys.begin(),
+                                                              keys.end());
+  std::sort(keys.begin(), keys.end());
+  for (const auto& key : keys) {
+    EXPECT_EQ(key, soft_heap.ExtractMin());
+  }
+}
+
+namespace detail {
+
+// A key with no default constructor
+class Timestamp {
+ public:
+  explicit Timestamp(int ticks) : ticks(ticks) {}
+  friend auto operator<=>(const Timestamp&, const Timestamp&) = default;
+
+ private:
+  int ticks;
+};
+
+template <class Heap>
+void ExpectDrainsSorted() {
+  auto keys = std::vector<Timestamp>();
+  for (auto x : generate_rand(3000)) {
+    keys.emplace_back(x);
+  }
+  auto soft_heap = Heap(keys.cbegin(), keys.cend());
+  for (int i = 3000; i < 3500; ++i) {
+    soft_heap.Insert(Timestamp(i));
+    keys.emplace_back(i);
+  }
+  auto extracted = std::vector<Timestamp>();
+  while (soft_heap.size() != 0) {
+    extracted.push_back(soft_heap.ExtractMin());
+  }
+  std::sort(keys.begin(), keys.end());
+  std::sort(extracted.begin(), extracted.end());
+  EXPECT_EQ(extracted, keys);
+}
+
+}  // namespace detail
+
+TEST(FlatSoftHeap, KeysWithoutDefaultConstructor) {
+  using detail::Timestamp;
+  static_assert(not std::default_initializable<Timestamp>);
+  detail::ExpectDrainsSorted<FlatSoftHeap<Timestamp, InlineList<Timestamp>,
+                                          2>>();
+  detail::ExpectDrainsSorted<
+      FlatSoftHeap<Timestamp, std::vector<Timestamp>, 2, policy::RankedRoots,
+                   policy::NaturalOrder, policy::SplitArrayLayout>>();
+}
+
+// Same links, same sifts: the flat tree is the pointer tree in an array, up
+// to the first compaction of a sparse flat tree. Both still drain the same
+// keys after it.
+TEST(FlatSoftHeapCompare, MatchesSoftHeapWithCorruption) {
+  auto rand = detail::generate_rand(3000);
+  auto soft_heap = SoftHeap<int, vector<int>, 4>(rand.begin(), rand.end());
+  auto flat_soft_heap =
+      FlatSoftHeap<int, vector<int>, 4, policy::LinkedRoots,
+                   policy::NaturalOrder, policy::NodeArrayLayout,
+                   policy::AutoMinRoots, policy::CountingStats>(rand.begin(),
+                                                                rand.end());
+  auto drained = vector<int>();
+  auto flat_drained = vector<int>();
+  const auto extract_both = [&] {
+    const auto linked_alike = flat_soft_heap.stats().compactions == 0;
+    drained.push_back(soft_heap.ExtractMin());
+    flat_drained.push_back(flat_soft_heap.ExtractMin());
+    if (linked_alike) {
+      EXPECT_EQ(drained.back(), flat_drained.back());
+    }
+  };
+  for (int i = 0; i < 1000; ++i) {
+    extract_both();
+  }
+  for (int i = 0; i < 1000; ++i) {
+    soft_heap.Insert(rand[i]);
+    flat_soft_heap.Insert(rand[i]);
+  }
+  while (soft_heap.size() != 0) {
+    extract_both();
+  }
+  EXPECT_EQ(0, flat_soft_heap.size());
+  EXPECT_NE(flat_soft_heap.stats().compactions, 0);
+  std::ranges::sort(drained);
+  std::ranges::sort(flat_drained);
+  EXPECT_EQ(drained, flat_drained);
+}
+
 TEST(FlatSoftHeapCompare, ExtractCompare) {
   auto rand = detail::generate_rand(2000);
   auto soft_heap =
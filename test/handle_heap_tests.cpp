@@ -0,0 +1,218 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <set>
+#include <span>
+#include <vector>
+
+#include "common.hpp"
+#include "handle_heap.hpp"
+
+namespace soft_heap::test {
+
+// NOLINTBEGIN(modernize-use-trailing-return-type)
+
+using ExactHeap = HandleSoftHeap<int, 1000>;
+
+TEST(HandleHeap, DeleteSkipsElement) {
+  auto soft_heap = ExactHeap();
+  const auto one = soft_heap.Insert(1);
+  soft_heap.Insert(2);
+  const auto three = soft_heap.Insert(3);
+  EXPECT_TRUE(soft_heap.Delete(one));
+  EXPECT_FALSE(soft_heap.Delete(one));  // already gone
+  EXPECT_FALSE(soft_heap.Contains(one));
+  EXPECT_TRUE(soft_heap.Contains(three));
+  EXPECT_EQ(2, soft_heap.size());
+  EXPECT_EQ(2, soft_heap.Top().element);
+  EXPECT_EQ(2, soft_heap.ExtractMin().element);
+  EXPECT_EQ(3, soft_heap.ExtractMin().element);
+  EXPECT_EQ(0, soft_heap.size());
+  EXPECT_TRUE(soft_heap.trees.empty());
+  EXPECT_FALSE(soft_heap.Delete(three));  // extracted
+}
+
+TEST(HandleHeap, RecycledSlotKeepsOldHandleStale) {
+  auto soft_heap = ExactHeap();
+  const auto old = soft_heap.Insert(5);
+  EXPECT_EQ(5, soft_heap.ExtractMin().element);
+  const auto reused = soft_heap.Insert(7);
+  EXPECT_EQ(old.slot, reused.slot);
+  EXPECT_NE(old, reused);
+  EXPECT_FALSE(soft_heap.Delete(old));
+  EXPECT_EQ(7, soft_heap.ExtractMin().element);
+}
+
+TEST(HandleHeap, DeleteFreesTheSlotAtOnce) {
+  auto soft_heap = ExactHeap();
+  soft_heap.Insert(1);
+  const auto two = soft_heap.Insert(2);
+  EXPECT_TRUE(soft_heap.Delete(two));
+  EXPECT_EQ(1, soft_heap.tombstones());  // the entry is still in a list
+  const auto three = soft_heap.Insert(3);
+  EXPECT_EQ(two.slot, three.slot);
+  EXPECT_FALSE(soft_heap.Contains(two));
+  EXPECT_EQ(1, soft_heap.ExtractMin().element);
+  EXPECT_EQ(0, soft_heap.tombstones());  // dropped as it surfaced
+  EXPECT_EQ(3, soft_heap.ExtractMin().element);
+}
+
+TEST(HandleHeap, DecreaseKey) {
+  auto soft_heap = ExactHeap();
+  soft_heap.Insert(10);
+  auto handle = soft_heap.Insert(20);
+  soft_heap.Insert(30);
+  handle = *soft_heap.DecreaseKey(handle, 5);
+  EXPECT_EQ(5, soft_heap.Top().element);
+  EXPECT_EQ(5, soft_heap.ExtractMin().element);
+  EXPECT_EQ(soft_heap.DecreaseKey(handle, 1), std::nullopt);
+  EXPECT_EQ(10, soft_heap.ExtractMin().element);
+  EXPECT_EQ(30, soft_heap.ExtractMin().element);
+}
+
+TEST(HandleHeap, PurgeBoundsTombstones) {
+  auto rand = detail::generate_rand(3000);
+  auto soft_heap = ExactHeap();
+  auto handles = std::vector<Handle>();
+  for (auto x : rand) {
+    handles.push_back(soft_heap.Insert(x));
+  }
+  auto kept = std::multiset<int>();
+  for (std::size_t i = 0; i < rand.size(); ++i) {
+    if (rand[i] % 3 == 0) {
+      kept.insert(rand[i]);
+    } else {
+      EXPECT_TRUE(soft_heap.Delete(handles[i]));
+    }
+    EXPECT_LE(soft_heap.tombstones(), soft_heap.size());
+  }
+  EXPECT_EQ(kept.size(), soft_heap.size());
+  for (auto x : kept) {
+    EXPECT_EQ(x, soft_heap.ExtractMin().element);
+  }
+}
+
+TEST(HandleHeap, BulkEntriesCarryNoHandle) {
+  auto rand = detail::generate_rand(1000);
+  auto soft_heap = ExactHeap(rand.begin(), rand.end());
+  const auto handle = soft_heap.Insert(-1);
+  soft_heap.InsertRange(rand.begin(), rand.end());
+  EXPECT_TRUE(soft_heap.Delete(handle));
+  EXPECT_EQ(2 * rand.size(), soft_heap.size());
+  std::ranges::sort(rand);
+  for (auto x : rand) {
+    EXPECT_EQ(x, soft_heap.ExtractMin().element);
+    EXPECT_EQ(x, soft_heap.ExtractMin().element);
+  }
+}
+
+namespace detail {
+
+template <class Heap>
+concept CanMeld = requires(Heap heap, Heap&& that) {
+  heap.Meld(std::move(that));
+};
+
+template <class Heap>
+concept CanAbsorb = requires(Heap heap, Heap&& that) {
+  heap.Absorb(std::move(that));
+};
+
+}  // namespace detail
+
+// Tracked heaps take other heaps in only through InsertRange
+static_assert(not detail::CanMeld<ExactHeap>);
+static_assert(not detail::CanAbsorb<ExactHeap>);
+static_assert(not detail::CanMeld<HandleFlatSoftHeap<int, 1000>>);
+static_assert(not detail::CanAbsorb<HandleFlatSoftHeap<int, 1000>>);
+static_assert(detail::CanMeld<SoftHeap<int>>);
+static_assert(not detail::CanAbsorb<SoftHeap<int>>);
+
+namespace detail {
+
+template <class Heap>
+auto WalkCorrupted(Heap& heap) -> std::size_t {
+  auto num = std::size_t{0};
+  for (auto& tree : heap.trees) {
+    if constexpr (requires { tree.node_heap; }) {
+      const auto& nodes = tree.node_heap;
+      for (std::ptrdiff_t idx = 0; idx < nodes.ssize(); ++idx) {
+        if (not tree.Vacant(idx)) {
+          num += std::ranges::count_if(nodes.elements(idx), [&](auto& x) {
+            return x.element < nodes.ckey(idx);
+          });
+        }
+      }
+    } else {
+      num += static_cast<std::size_t>(tree.num_corrupted_keys());
+    }
+  }
+  return num;
+}
+
+// Random Insert/DecreaseKey/Delete mix with extractions in between; many
+// keys end up at 0. Tombstones dropped by sifts must leave the corruption
+// count exact.
+template <class HeapType>
+void MixedOps() {
+  auto gen = std::mt19937(7);
+  auto soft_heap = HeapType();
+  auto live = std::vector<std::pair<Handle, int>>();
+  auto expected = std::multiset<int>();
+  auto out = std::vector<Tagged<int>>(16, 0);
+  for (int i = 0; i < 5000; ++i) {
+    const auto op = gen() % 8;
+    if (op < 4 or live.empty()) {
+      const auto key = static_cast<int>(gen() % 100000);
+      live.emplace_back(soft_heap.Insert(key), key);
+      expected.insert(key);
+    } else if (op < 7) {
+      const auto pick = gen() % live.size();
+      auto& [handle, key] = live[pick];
+      expected.erase(expected.find(key));
+      if (op == 4) {
+        key /= 2;
+        handle = *soft_heap.DecreaseKey(handle, key);
+        expected.insert(key);
+      } else {
+        EXPECT_TRUE(soft_heap.Delete(handle));
+        live[pick] = live.back();
+        live.pop_back();
+      }
+    } else {
+      const auto batch = std::span(out).first(1 + gen() % out.size());
+      const auto taken = soft_heap.ExtractMinBatch(batch);
+      for (const auto& entry : batch.first(taken)) {
+        expected.erase(expected.find(entry.element));
+      }
+      std::erase_if(live, [&](const auto& entry) {
+        return not soft_heap.Contains(entry.first);
+      });
+    }
+    ASSERT_EQ(expected.size(), soft_heap.size());
+    ASSERT_EQ(soft_heap.num_corrupted_keys(), WalkCorrupted(soft_heap));
+  }
+  auto extracted = std::multiset<int>();
+  while (soft_heap.size() != 0) {
+    extracted.insert(soft_heap.ExtractMin().element);
+  }
+  EXPECT_EQ(expected, extracted);
+  EXPECT_TRUE(soft_heap.trees.empty());
+}
+
+}  // namespace detail
+
+TEST(HandleHeap, DijkstraStyleMixedOps) {
+  detail::MixedOps<HandleSoftHeap<int, 4>>();
+}
+
+TEST(HandleHeap, FlatDijkstraStyleMixedOps) {
+  detail::MixedOps<HandleFlatSoftHeap<int, 4>>();
+}
+
+// NOLINTEND(modernize-use-trailing-return-type)
+
+}  // namespace soft_heap::test
@@ -0,0 +1,148 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <queue>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "common.hpp"
+#include "flat_soft_heap.hpp"
+#include "inline_list.hpp"
+#include "soft_heap.hpp"
+
+namespace soft_heap::test {
+
+// NOLINTBEGIN(modernize-use-trailing-return-type)
+
+using ::testing::ElementsAre;
+using List = InlineList<int, 2>;
+
+TEST(InlineList, StaysInlineUpToCapacity) {
+  auto list = List{1};
+  EXPECT_TRUE(list.is_inline());
+  list.push_back(2);
+  EXPECT_TRUE(list.is_inline());
+  EXPECT_EQ(list.capacity(), 2);
+  list.push_back(3);
+  EXPECT_FALSE(list.is_inline());
+  EXPECT_EQ(list.capacity(), 4);
+  EXPECT_THAT(list, ElementsAre(1, 2, 3));
+  for (int i = 3; i > 0; --i) {
+    EXPECT_EQ(list.back(), i);
+    list.pop_back();
+  }
+  EXPECT_TRUE(list.empty());
+  EXPECT_EQ(list.begin(), list.end());
+}
+
+TEST(InlineList, MoveStealsSpilledBuffer) {
+  auto list = List{1, 2, 3, 4, 5};
+  const auto* data = &*list.begin();
+  auto moved = std::move(list);
+  EXPECT_EQ(&*moved.begin(), data);
+  EXPECT_TRUE(list.empty());    // NOLINT(bugprone-use-after-move)
+  EXPECT_TRUE(list.is_inline());
+  auto small = List{6};
+  moved = std::move(small);
+  EXPECT_THAT(moved, ElementsAre(6));
+  EXPECT_TRUE(moved.is_inline());
+}
+
+TEST(InlineList, InsertAppends) {
+  auto list = List{1};
+  const auto that = std::vector<int>{2, 3, 4};
+  list.insert(list.end(), that.begin(), that.end());
+  EXPECT_THAT(list, ElementsAre(1, 2, 3, 4));
+  list.insert(list.begin(), that.begin(), std::next(that.begin()));
+  EXPECT_THAT(list, ElementsAre(2, 1, 2, 3, 4));
+}
+
+TEST(InlineList, NonTrivialElements) {
+  auto list = InlineList<std::string, 1>{"a"};
+  list.emplace_back(40, 'b');
+  auto copy = list;
+  EXPECT_EQ(copy, list);
+  swap(copy, list);
+  EXPECT_EQ(list.back(), std::string(40, 'b'));
+  copy.pop_back();
+  EXPECT_LT(copy, list);
+}
+
+TEST(InlineList, AppendsItsOwnElementsAcrossGrowth) {
+  const auto a = std::string(40, 'a');
+  const auto b = std::string(40, 'b');
+  auto list = InlineList<std::string, 1>{a};
+  list.push_back(list.back());  // inline buffer full
+  list.emplace_back(list.back());  // spilled buffer full
+  EXPECT_THAT(list, ElementsAre(a, a, a));
+  list.back() = b;
+  list.insert(list.end(), list.begin(), list.end());
+  EXPECT_THAT(list, ElementsAre(a, a, b, a, a, b));
+  list.insert(list.begin(), list.end() - 1, list.end());  // fits in place
+  EXPECT_THAT(list, ElementsAre(b, a, a, b, a, a, b));
+}
+
+TEST(InlineList, OnlyAllocatingPathsMayThrow) {
+  auto list = List();
+  EXPECT_FALSE(noexcept(list.push_back(1)));
+  EXPECT_FALSE(noexcept(list.reserve(8)));
+  EXPECT_TRUE(std::is_nothrow_move_constructible_v<List>);
+  EXPECT_TRUE(noexcept(list.pop_back()));
+}
+
+TEST(InlineList, CopyAndCompare) {
+  const auto list = List{1, 2, 3};
+  auto copy = list;
+  EXPECT_EQ(copy, list);
+  copy.pop_back();
+  EXPECT_LT(copy, list);
+  copy.push_back(4);
+  EXPECT_GT(copy, list);
+}
+
+TEST(InlineList, NodeSift) {
+  using N = Node<int, List, 8>;
+  auto node = std::make_unique<N>(10, 4, List{1});
+  node->left = std::make_unique<N>(9, 1, List{2, 3});
+  node->right = std::make_unique<N>(9, 1, List{5});
+  node->Sift();
+  EXPECT_NODE_EQ(node, N{10, 4, List{1, 2, 3, 5}});
+  EXPECT_TRUE(node->IsLeaf());
+}
+
+TEST(InlineList, SoftHeapMatchesVector) {
+  auto rand = detail::generate_rand(3000);
+  auto vector_heap =
+      SoftHeap<int, std::vector<int>, 4>(rand.begin(), rand.end());
+  auto inline_heap = SoftHeap<int, List, 4>(rand.begin(), rand.end());
+  EXPECT_EQ(vector_heap.num_corrupted_keys(),
+            inline_heap.num_corrupted_keys());
+  for ([[maybe_unused]] auto&& x : rand) {
+    EXPECT_EQ(inline_heap.ExtractMin(), vector_heap.ExtractMin());
+  }
+}
+
+TEST(InlineList, FlatSoftHeapMatchesVector) {
+  auto rand = detail::generate_rand(3000);
+  auto vector_heap =
+      FlatSoftHeap<int, std::vector<int>, 4>(rand.begin(), rand.end());
+  auto inline_heap = FlatSoftHeap<int, List, 4>(rand.begin(), rand.end());
+  for ([[maybe_unused]] auto&& x : rand) {
+    EXPECT_EQ(inline_heap.ExtractMin(), vector_heap.ExtractMin());
+  }
+  EXPECT_EQ(0, inline_heap.size());
+}
+
+TEST(InlineList, IsTheDefaultElementList) {
+  EXPECT_TRUE((std::is_same_v<SoftHeap<int>::NodeType,
+                              Node<int, InlineList<int>, 8>>));
+  EXPECT_TRUE((std::is_same_v<FlatSoftHeap<int>::TreeType,
+                              FlatTree<int, InlineList<int>, 8>>));
+}
+
+// NOLINTEND(modernize-use-trailing-return-type)
+
+}  // namespace soft_heap::test
@@ -0,0 +1,90 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <limits>
+#include <random>
+
+#include "latency_histogram.hpp"
+
+namespace soft_heap::test {
+
+// NOLINTBEGIN(modernize-use-trailing-return-type)
+
+TEST(LatencyHistogram, Empty) {
+  const auto histogram = LatencyHistogram();
+  EXPECT_EQ(histogram.count(), 0);
+  EXPECT_EQ(histogram.Percentile(0.5), 0);
+  EXPECT_EQ(histogram.min(), 0);
+  EXPECT_EQ(histogram.max(), 0);
+  EXPECT_EQ(histogram.mean(), 0);
+}
+
+TEST(LatencyHistogram, SmallValuesAreExact) {
+  auto histogram = LatencyHistogram();
+  for (std::uint64_t v = 1; v <= 100; ++v) {
+    histogram.Record(v);
+  }
+  EXPECT_EQ(histogram.count(), 100);
+  EXPECT_EQ(histogram.min(), 1);
+  EXPECT_EQ(histogram.max(), 100);
+  EXPECT_DOUBLE_EQ(histogram.mean(), 50.5);
+  EXPECT_EQ(histogram.Percentile(0), 1);
+  EXPECT_EQ(histogram.Percentile(0.5), 50);
+  EXPECT_EQ(histogram.Percentile(0.99), 99);
+  EXPECT_EQ(histogram.Percentile(0.999), 100);
+  EXPECT_EQ(histogram.Percentile(1), 100);
+}
+
+TEST(LatencyHistogram, LargeValuesWithinRelativeError) {
+  const auto tolerance = 1.0 / (1 << (LatencyHistogram::precision_bits - 1));
+  auto gen = std::mt19937_64(7);
+  for (int i = 0; i < 2'000; ++i) {
+    const auto v = gen() >> (gen() % 64);
+    auto histogram = LatencyHistogram();
+    histogram.Record(v);
+    histogram.Record(std::numeric_limits<std::uint64_t>::max());
+    // the top of v's bucket, as the max clamps the 100th percentile only
+    const auto p = histogram.Percentile(0.5);
+    EXPECT_GE(p, v);
+    EXPECT_LE(static_cast<double>(p - v), tolerance * static_cast<double>(v))
+        << v;
+    EXPECT_EQ(histogram.Percentile(1),
+              std::numeric_limits<std::uint64_t>::max());
+  }
+}
+
+TEST(LatencyHistogram, TailPercentiles) {
+  auto histogram = LatencyHistogram();
+  for (int i = 0; i < 9'990; ++i) {
+    histogram.Record(100);
+  }
+  for (int i = 0; i < 9; ++i) {
+    histogram.Record(50'000);
+  }
+  histogram.Record(1'000'000);
+  EXPECT_EQ(histogram.Percentile(0.5), 100);
+  EXPECT_EQ(histogram.Percentile(0.99), 100);
+  EXPECT_NEAR(histogram.Percentile(0.9995), 50'000, 50'000 / 128);
+  EXPECT_EQ(histogram.Percentile(1), 1'000'000);
+  EXPECT_EQ(histogram.max(), 1'000'000);
+}
+
+TEST(LatencyHistogram, MergeAddsCounts) {
+  auto x = LatencyHistogram();
+  auto y = LatencyHistogram();
+  for (std::uint64_t v = 1; v <= 50; ++v) {
+    x.Record(v);
+    y.Record(v + 50);
+  }
+  x.Merge(y);
+  EXPECT_EQ(x.count(), 100);
+  EXPECT_EQ(x.min(), 1);
+  EXPECT_EQ(x.max(), 100);
+  EXPECT_EQ(x.Percentile(0.5), 50);
+  EXPECT_EQ(x.Percentile(0.75), 75);
+}
+
+// NOLINTEND(modernize-use-trailing-return-type)
+
+}  // namespace soft_heap::test
@@ -0,0 +1,216 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <queue>
+#include <vector>
+
+#include "common.hpp"
+#include "node.hpp"
+#include "node_pool.hpp"
+#include "soft_heap.hpp"
+
+namespace soft_heap::test {
+
+// NOLINTBEGIN(modernize-use-trailing-return-type)
+
+using PooledNode =
+    Node<int, std::vector<int>, 8, policy::PoolAllocation<4>>;
+
+TEST(NodePool, MakeAndRelease) {
+  auto pool = NodePool<PooledNode, 4>();
+  EXPECT_EQ(pool.capacity(), 0);
+  {
+    auto node = pool.Make(3);
+    EXPECT_EQ(pool.live(), 1);
+    EXPECT_EQ(pool.capacity(), 4);
+    EXPECT_NODE_EQ(node, PooledNode{0, 1, {3}});
+  }
+  EXPECT_EQ(pool.live(), 0);
+}
+
+TEST(NodePool, OnlyAllocatingPathsMayThrow) {
+  using Heap = SoftHeap<int, InlineList<int>, 8, policy::PoolAllocation<>>;
+  auto pool = NodePool<PooledNode, 4>();
+  auto resource = policy::PoolAllocation<4>::Resource<PooledNode>();
+  const auto keys = std::vector<int>{1, 2, 3};
+  EXPECT_FALSE(noexcept(pool.Make(1)));
+  EXPECT_FALSE(noexcept(pool.Reserve(8)));
+  EXPECT_FALSE(noexcept(resource.Make(1)));
+  EXPECT_FALSE(noexcept(resource.Reserve(8)));
+  EXPECT_FALSE(noexcept(Heap(keys.begin(), keys.end())));
+  EXPECT_TRUE(std::is_nothrow_move_constructible_v<Heap>);
+  EXPECT_TRUE(noexcept(resource.live()));
+}
+
+TEST(NodePool, RecyclesFreedSlots) {
+  auto pool = NodePool<PooledNode, 4>();
+  auto first = pool.Make(1);
+  auto second = pool.Make(2);
+  auto* const freed = second.get();
+  second.reset();
+  EXPECT_EQ(pool.Make(3).get(), freed);  // freed slot reused
+  EXPECT_NE(pool.Make(4).get(), first.get());
+  EXPECT_EQ(pool.capacity(), 4);
+}
+
+TEST(NodePool, GrowsBySlab) {
+  auto pool = NodePool<PooledNode, 4>();
+  auto nodes = std::vector<PooledNode::NodePtr>();
+  for (int i = 0; i < 9; ++i) {
+    nodes.push_back(pool.Make(std::move(i)));
+  }
+  EXPECT_EQ(pool.capacity(), 12);
+  EXPECT_EQ(pool.live(), 9);
+  nodes.clear();
+  EXPECT_EQ(pool.live(), 0);
+}
+
+TEST(NodePool, ReserveHandsOutReservedSlots) {
+  auto pool = NodePool<PooledNode, 4>();
+  auto first = pool.Make(1);
+  pool.Reserve(6);
+  EXPECT_EQ(pool.capacity(), 8);
+  auto nodes = std::vector<PooledNode::NodePtr>();
+  for (int i = 0; i < 6; ++i) {
+    nodes.push_back(pool.Make(std::move(i)));
+  }
+  EXPECT_EQ(pool.capacity(), 8);
+  EXPECT_EQ(pool.live(), 7);
+  pool.Reserve(1);  // already have room
+  EXPECT_EQ(pool.capacity(), 8);
+}
+
+TEST(NodePool, CombineReturnsChildrenToPool) {
+  auto pool = NodePool<PooledNode, 4>();
+  auto node = pool.Make(pool.Make(1), pool.Make(2));
+  EXPECT_EQ(pool.live(), 2);  // leaf sifted up and released
+  EXPECT_EQ(node->ckey, 1);
+}
+
+TEST(NodePool, SoftHeapExtractMin) {
+  auto rand = detail::generate_rand(3000);
+  auto soft_heap =
+      SoftHeap<int, std::vector<int>, 1000, policy::PoolAllocation<>>(
+          rand.begin(), rand.end());
+  auto stl_heap =
+      std::priority_queue(rand.begin(), rand.end(), std::greater<>());
+  while (not stl_heap.empty()) {
+    EXPECT_EQ(soft_heap.ExtractMin(), stl_heap.top());
+    stl_heap.pop();
+  }
+  EXPECT_EQ(0, soft_heap.size());
+  EXPECT_EQ(0, soft_heap.node_resource.live());
+}
+
+TEST(NodePool, SoftHeapMeldAdoptsPool) {
+  using Heap = SoftHeap<int, std::vector<int>, 4, policy::PoolAllocation<>>;
+  auto rand = detail::generate_rand(2000);
+  auto mid = std::next(rand.begin(), 1000);
+  auto soft_heap = Heap(rand.begin(), mid);
+  soft_heap.Meld(Heap(mid, rand.end()));
+  EXPECT_EQ(soft_heap.node_resource.adopted.size(), 1);
+
+  std::set<int> extracted_elems;
+  for ([[maybe_unused]] auto&& x : rand) {
+    EXPECT_TRUE(extracted_elems.insert(soft_heap.ExtractMin()).second);
+  }
+  EXPECT_EQ(0, soft_heap.node_resource.live());
+}
+
+TEST(NodePool, MeldOfEmptyHeapAdoptsNothing) {
+  using Heap = SoftHeap<int, std::vector<int>, 4, policy::PoolAllocation<>>;
+  auto rand = detail::generate_rand(100);
+  auto soft_heap = Heap(rand.begin(), rand.end());
+  auto* const pool = soft_heap.node_resource.pool.get();
+  for (int i = 0; i < 100; ++i) {
+    soft_heap.Meld(Heap());
+  }
+  EXPECT_TRUE(soft_heap.node_resource.adopted.empty());
+  EXPECT_EQ(soft_heap.node_resource.pool.get(), pool);
+}
+
+TEST(NodePool, DrainedAdoptedPoolsAreDropped) {
+  using Heap = SoftHeap<int, std::vector<int>, 4, policy::PoolAllocation<>>;
+  auto soft_heap = Heap();
+  for (int round = 0; round < 50; ++round) {
+    auto rand = detail::generate_rand(64, round);
+    soft_heap.Meld(Heap(rand.begin(), rand.end()));
+    EXPECT_LE(soft_heap.node_resource.adopted.size(), 1);
+    while (soft_heap.size() != 0) {
+      EXPECT_GE(soft_heap.ExtractMin(), 1);
+    }
+    EXPECT_EQ(soft_heap.node_resource.live(), 0);
+  }
+}
+
+TEST(NodePool, AdoptedSlotsAreReused) {
+  using Heap = SoftHeap<int, std::vector<int>, 4, policy::PoolAllocation<>>;
+  auto rand = detail::generate_rand(2000);
+  auto mid = std::next(rand.begin(), 1000);
+  auto soft_heap = Heap(rand.begin(), mid);
+  soft_heap.Meld(Heap(mid, rand.end()));
+  const auto capacity = soft_heap.node_resource.pool->capacity();
+  for (int round = 0; round < 3; ++round) {
+    while (soft_heap.size() != 0) {
+      EXPECT_GE(soft_heap.ExtractMin(), 1);
+    }
+    for (auto x : rand) {
+      soft_heap.Insert(std::move(x));
+    }
+  }
+  EXPECT_EQ(soft_heap.node_resource.pool->capacity(), capacity);
+  EXPECT_TRUE(soft_heap.node_resource.adopted.empty());
+}
+
+TEST(NodePool, ChainedMeldsForwardToTheLastHeap) {
+  using Heap = SoftHeap<int, std::vector<int>, 4, policy::PoolAllocation<>>;
+  auto rand = detail::generate_rand(3000);
+  auto first = std::next(rand.begin(), 1000);
+  auto second = std::next(rand.begin(), 2000);
+  auto x = Heap(rand.begin(), first);
+  auto y = Heap(first, second);
+  auto z = Heap(second, rand.end());
+  y.Meld(std::move(x));
+  z.Meld(std::move(y));
+  EXPECT_EQ(z.node_resource.adopted.size(), 2);
+  std::set<int> extracted_elems;
+  for ([[maybe_unused]] auto&& e : rand) {
+    EXPECT_TRUE(extracted_elems.insert(z.ExtractMin()).second);
+  }
+  EXPECT_EQ(z.node_resource.live(), 0);
+  for (const auto& pool : z.node_resource.adopted) {
+    EXPECT_EQ(pool->live(), 0);
+  }
+}
+
+TEST(NodePool, MoveAssignedHeapsStayUsable) {
+  using Heap = SoftHeap<int, InlineList<int>, 8, policy::PoolAllocation<>>;
+  auto rand = detail::generate_rand(1000);
+  auto mid = std::next(rand.begin(), 500);
+  auto x = Heap(rand.begin(), mid);
+  auto y = Heap(mid, rand.end());
+  x = std::move(y);
+  EXPECT_EQ(x.size(), 500);
+  EXPECT_EQ(y.size(), 0);
+  EXPECT_EQ(y.node_resource.live(), 0);
+  for (auto e : rand) {
+    y.Insert(std::move(e));
+  }
+  std::set<int> extracted_elems;
+  while (x.size() != 0) {
+    EXPECT_TRUE(extracted_elems.insert(x.ExtractMin()).second);
+  }
+  EXPECT_EQ(x.node_resource.live(), 0);
+  x.Insert(1);
+  EXPECT_EQ(x.ExtractMin(), 1);
+  extracted_elems.clear();
+  while (y.size() != 0) {
+    EXPECT_TRUE(extracted_elems.insert(y.ExtractMin()).second);
+  }
+  EXPECT_EQ(std::ssize(extracted_elems), 1000);
+  EXPECT_EQ(y.node_resource.live(), 0);
+}
+
+// NOLINTEND(modernize-use-trailing-return-type)
+
+}  // namespace soft_heap::test
@@ -0,0 +1,122 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <concepts>
+#include <functional>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "common.hpp"
+#include "flat_soft_heap.hpp"
+#include "order.hpp"
+#include "runtime_epsilon.hpp"
+#include "soft_heap.hpp"
+
+namespace soft_heap::test {
+
+// NOLINTBEGIN(modernize-use-trailing-return-type)
+
+namespace detail {
+
+struct First {
+  constexpr auto operator()(const std::pair<int, int>& x) const noexcept {
+    return x.first;
+  }
+};
+
+using Job = std::pair<int, int>;  // priority, payload
+using ByPriority = policy::KeyOrder<First>;
+
+}  // namespace detail
+
+using MaxHeap = SoftHeap<int, std::vector<int>, 1000, policy::HeapAllocation,
+                         policy::LinkedRoots, policy::ReverseOrder<>>;
+
+TEST(Order, MaxHeapExtractsLargestFirst) {
+  auto rand = detail::generate_rand(3000);
+  auto soft_heap = MaxHeap(rand.begin(), rand.end());
+  EXPECT_EQ(3000, soft_heap.Top());
+  for (int i = 3000; i > 0; --i) {
+    EXPECT_EQ(i, soft_heap.ExtractMin());
+  }
+}
+
+TEST(Order, MaxHeapRankedRootsMeld) {
+  using Heap = SoftHeap<int, std::vector<int>, 1000, policy::HeapAllocation,
+                        policy::RankedRoots, policy::ReverseOrder<>>;
+  auto rand = detail::generate_rand(2000);
+  auto mid = std::next(rand.begin(), 777);
+  auto soft_heap = Heap(rand.begin(), mid);
+  soft_heap.Meld(Heap(mid, rand.end()));
+  for (int i = 2000; i > 0; --i) {
+    EXPECT_EQ(i, soft_heap.ExtractMin());
+  }
+}
+
+TEST(Order, ProjectionKeepsOnlyKeyAsCKey) {
+  using Heap = SoftHeap<detail::Job, std::vector<detail::Job>, 1000,
+                        policy::HeapAllocation, policy::LinkedRoots,
+                        detail::ByPriority>;
+  static_assert(std::same_as<decltype(Heap::NodeType::ckey), int>);
+  auto rand = detail::generate_rand(2000);
+  auto soft_heap = Heap();
+  for (auto x : rand) {
+    soft_heap.Insert({x, -x});
+  }
+  for (int i = 1; i <= 2000; ++i) {
+    EXPECT_EQ(i, soft_heap.TopCKey());
+    EXPECT_EQ(soft_heap.ExtractMin(), detail::Job(i, -i));
+  }
+}
+
+TEST(Order, ProjectionWithCorruption) {
+  using Heap = SoftHeap<detail::Job, std::vector<detail::Job>, 2,
+                        policy::HeapAllocation, policy::LinkedRoots,
+                        detail::ByPriority>;
+  auto rand = detail::generate_rand(3000);
+  auto jobs = std::vector<detail::Job>();
+  for (auto x : rand) {
+    jobs.emplace_back(x, 3 * x);
+  }
+  auto soft_heap = Heap(jobs.begin(), jobs.end());
+  EXPECT_LE(soft_heap.num_corrupted_keys(), 3000 / 2);
+  auto extracted = std::vector<detail::Job>();
+  for ([[maybe_unused]] auto&& x : jobs) {
+    extracted.push_back(soft_heap.ExtractMin());
+    EXPECT_EQ(3 * extracted.back().first, extracted.back().second);
+  }
+  std::sort(jobs.begin(), jobs.end());
+  std::sort(extracted.begin(), extracted.end());
+  EXPECT_EQ(jobs, extracted);
+}
+
+TEST(Order, FlatSoftHeapMaxHeap) {
+  auto rand = detail::generate_rand(3000);
+  auto soft_heap =
+      FlatSoftHeap<int, std::vector<int>, 4, policy::LinkedRoots,
+                   policy::ReverseOrder<>>(rand.begin(), rand.end());
+  auto extracted = std::vector<int>();
+  for ([[maybe_unused]] auto&& x : rand) {
+    extracted.push_back(soft_heap.ExtractMin());
+  }
+  std::sort(rand.begin(), rand.end());
+  std::sort(extracted.begin(), extracted.end());
+  EXPECT_EQ(rand, extracted);
+}
+
+TEST(Order, RuntimeSoftHeapMaxHeap) {
+  auto rand = detail::generate_rand(1000);
+  auto soft_heap =
+      RuntimeSoftHeap<int, std::vector<int>, policy::HeapAllocation,
+                      policy::LinkedRoots, policy::ReverseOrder<>>(
+          1e-9, rand.begin(), rand.end());
+  for (int i = 1000; i > 0; --i) {
+    EXPECT_EQ(i, soft_heap.ExtractMin());
+  }
+}
+
+// NOLINTEND(modernize-use-trailing-return-type)
+
+}  // namespace soft_heap::test
@@ -0,0 +1,80 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "common.hpp"
+#include "flat_soft_heap.hpp"
+#include "parallel_build.hpp"
+#include "soft_heap.hpp"
+
+namespace soft_heap::test {
+
+// NOLINTBEGIN(modernize-use-trailing-return-type)
+
+namespace detail {
+
+// Drains the heap; sorted output means no key was corrupted
+template <class Heap>
+auto Drain(Heap& heap) {
+  auto out = std::vector<int>();
+  while (heap.size() != 0) {
+    out.push_back(heap.ExtractMin());
+  }
+  return out;
+}
+
+}  // namespace detail
+
+// Far above the rank any of these inputs reach, so nothing is corrupted
+constexpr int exact = 1 << 20;
+
+TEST(ParallelBuild, SoftHeapMatchesSortedInput) {
+  auto rand = detail::generate_rand(70'000);
+  for (std::size_t threads : {0, 1, 3, 4}) {  // 0 as if unknown
+    auto heap = ParallelBuild<SoftHeap<int, std::vector<int>, exact>>(
+        rand.begin(), rand.end(), threads);
+    EXPECT_EQ(heap.size(), rand.size());
+    auto out = detail::Drain(heap);
+    EXPECT_TRUE(std::ranges::is_sorted(out));
+    EXPECT_EQ(out.size(), rand.size());
+  }
+}
+
+TEST(ParallelBuild, FlatSoftHeapMatchesSortedInput) {
+  auto rand = detail::generate_rand(70'000);
+  auto heap = ParallelBuild<FlatSoftHeap<int, std::vector<int>, exact>>(
+      rand.begin(), rand.end(), 3);
+  auto out = detail::Drain(heap);
+  EXPECT_TRUE(std::ranges::is_sorted(out));
+  EXPECT_EQ(out.size(), rand.size());
+}
+
+TEST(ParallelBuild, CorruptedHeapKeepsEveryElement) {
+  auto rand = detail::generate_rand(70'000);
+  auto heap = ParallelBuild<SoftHeap<int, std::vector<int>, 4,
+                                     policy::PoolAllocation<>,
+                                     policy::RankedRoots>>(
+      rand.begin(), rand.end(), 4);
+  EXPECT_LE(heap.num_corrupted_keys(), rand.size() / 4);
+  auto out = detail::Drain(heap);
+  std::ranges::sort(out);
+  std::ranges::sort(rand);
+  EXPECT_EQ(out, rand);
+}
+
+TEST(ParallelBuild, SmallInputsStaySequential) {
+  auto rand = detail::generate_rand(1000);
+  auto heap = ParallelBuild<SoftHeap<int, std::vector<int>, 4>>(
+      rand.begin(), rand.end(), 8);
+  auto sequential =
+      SoftHeap<int, std::vector<int>, 4>(rand.begin(), rand.end());
+  for ([[maybe_unused]] auto&& x : rand) {
+    EXPECT_EQ(heap.ExtractMin(), sequential.ExtractMin());
+  }
+}
+
+// NOLINTEND(modernize-use-trailing-return-type)
+
+}  // namespace soft_heap::test
@@ -0,0 +1,178 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bit>
+#include <iterator>
+#include <queue>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "common.hpp"
+#include "flat_soft_heap.hpp"
+#include "ranked_trees.hpp"
+#include "soft_heap.hpp"
+
+namespace soft_heap::test {
+
+// NOLINTBEGIN(modernize-use-trailing-return-type)
+
+namespace detail {
+
+// A "tree" that just remembers which leaves were linked into it
+using Leaves = std::vector<int>;
+
+constexpr auto AppendLeaves = [](Leaves& into, Leaves&& from, int /*rank*/) {
+  into.insert(into.end(), from.begin(), from.end());
+};
+
+}  // namespace detail
+
+TEST(RankedTrees, CarryIsBinaryIncrement) {
+  auto trees = RankedTrees<detail::Leaves>();
+  EXPECT_TRUE(trees.empty());
+  EXPECT_EQ(trees.begin(), trees.end());
+  for (int i = 0; i < 11; ++i) {  // 11 = 0b1011
+    trees.Carry(0, detail::Leaves{i}, detail::AppendLeaves);
+  }
+  EXPECT_EQ(trees.size(), 3);
+  EXPECT_TRUE(trees.Occupied(0));
+  EXPECT_TRUE(trees.Occupied(1));
+  EXPECT_FALSE(trees.Occupied(2));
+  EXPECT_TRUE(trees.Occupied(3));
+  EXPECT_EQ(trees.front().size(), 1);
+  EXPECT_EQ(trees.back().size(), 8);
+
+  auto ranks = std::vector<int>();
+  for (auto it = trees.begin(); it != trees.end(); ++it) {
+    ranks.push_back(it.rank());
+  }
+  EXPECT_THAT(ranks, ::testing::ElementsAre(0, 1, 3));
+  EXPECT_EQ(std::prev(trees.end()).rank(), 3);
+  EXPECT_EQ(std::prev(trees.end(), 3), trees.begin());
+}
+
+TEST(RankedTrees, EraseAndTake) {
+  auto trees = RankedTrees<detail::Leaves>();
+  trees.Put(2, detail::Leaves{1, 2, 3, 4});
+  trees.Put(5, detail::Leaves{5});
+  EXPECT_EQ(trees.erase(trees.begin()).rank(), 5);
+  EXPECT_EQ(trees.size(), 1);
+  EXPECT_THAT(trees.Take(5), ::testing::ElementsAre(5));
+  EXPECT_TRUE(trees.empty());
+}
+
+TEST(RankedTrees, MergeIsBinaryAddition) {
+  auto trees = RankedTrees<detail::Leaves>();
+  auto that = RankedTrees<detail::Leaves>();
+  for (int i = 0; i < 5; ++i) {  // 0b101
+    trees.Carry(0, detail::Leaves{i}, detail::AppendLeaves);
+  }
+  for (int i = 5; i < 12; ++i) {  // 0b111
+    that.Carry(0, detail::Leaves{i}, detail::AppendLeaves);
+  }
+  const auto highest = trees.Merge(std::move(that), detail::AppendLeaves);
+  EXPECT_TRUE(that.empty());
+  EXPECT_EQ(highest.rank(), 3);  // 0b1100
+  EXPECT_EQ(trees.size(), 2);
+  EXPECT_TRUE(trees.Occupied(2));
+  EXPECT_TRUE(trees.Occupied(3));
+}
+
+TEST(RankedTrees, MovedFromIsEmptyAndReusable) {
+  auto trees = RankedTrees<detail::Leaves>();
+  trees.Put(3, detail::Leaves{1});
+  auto moved = std::move(trees);
+  EXPECT_EQ(moved.size(), 1);
+  EXPECT_TRUE(trees.empty());  // NOLINT(bugprone-use-after-move)
+  EXPECT_EQ(trees.size(), 0);
+  EXPECT_FALSE(trees.Occupied(3));
+  EXPECT_EQ(trees.begin(), trees.end());
+  EXPECT_EQ(std::distance(trees.begin(), trees.end()), 0);
+
+  trees.Carry(0, detail::Leaves{2}, detail::AppendLeaves);
+  EXPECT_EQ(trees.size(), 1);
+  EXPECT_TRUE(trees.Occupied(0));
+  moved = std::move(trees);
+  EXPECT_TRUE(trees.empty());  // NOLINT(bugprone-use-after-move)
+  trees = RankedTrees<detail::Leaves>();
+  EXPECT_EQ(trees.Merge(std::move(moved), detail::AppendLeaves).rank(), 0);
+  EXPECT_TRUE(moved.empty());  // NOLINT(bugprone-use-after-move)
+}
+
+using RankedSoftHeap = SoftHeap<int, std::vector<int>, 1000,
+                                policy::HeapAllocation, policy::RankedRoots>;
+
+TEST(RankedTrees, SoftHeapExtractMin) {
+  auto rand = detail::generate_rand(3001);
+  auto soft_heap = RankedSoftHeap(rand.begin(), rand.end());
+  EXPECT_EQ(3001, soft_heap.size());
+  EXPECT_EQ(std::popcount(3001U), soft_heap.trees.size());
+  auto stl_heap =
+      std::priority_queue(rand.begin(), rand.end(), std::greater<>());
+  while (not stl_heap.empty()) {
+    EXPECT_EQ(soft_heap.ExtractMin(), stl_heap.top());
+    stl_heap.pop();
+  }
+  EXPECT_EQ(0, soft_heap.size());
+  EXPECT_TRUE(soft_heap.trees.empty());
+}
+
+TEST(RankedTrees, SoftHeapMatchesLinkedRoots) {
+  auto rand = detail::generate_rand(2000);
+  auto linked = SoftHeap<int, std::vector<int>, 4>(rand.begin(), rand.end());
+  auto ranked = SoftHeap<int, std::vector<int>, 4, policy::HeapAllocation,
+                         policy::RankedRoots>(rand.begin(), rand.end());
+  ASSERT_EQ(linked.trees.size(), ranked.trees.size());
+  EXPECT_EQ(linked.rank(), ranked.rank());
+  for ([[maybe_unused]] auto&& x : rand) {
+    EXPECT_EQ(linked.ExtractMin(), ranked.ExtractMin());
+  }
+}
+
+TEST(RankedTrees, SoftHeapMeld) {
+  auto rand = detail::generate_rand(3000);
+  auto mid = std::next(rand.begin(), 1234);
+  auto soft_heap = RankedSoftHeap(rand.begin(), mid);
+  soft_heap.Meld(RankedSoftHeap(mid, rand.end()));
+  EXPECT_EQ(3000, soft_heap.size());
+  EXPECT_EQ(std::popcount(3000U), soft_heap.trees.size());
+  auto stl_heap =
+      std::priority_queue(rand.begin(), rand.end(), std::greater<>());
+  while (not stl_heap.empty()) {
+    EXPECT_EQ(soft_heap.ExtractMin(), stl_heap.top());
+    stl_heap.pop();
+  }
+}
+
+TEST(RankedTrees, SoftHeapInsertRange) {
+  auto rand = detail::generate_rand(3000);
+  auto mid = std::next(rand.begin(), 1234);
+  auto soft_heap = RankedSoftHeap(rand.begin(), mid);
+  soft_heap.InsertRange(mid, rand.end());
+  EXPECT_EQ(std::popcount(3000U), soft_heap.trees.size());
+  auto stl_heap =
+      std::priority_queue(rand.begin(), rand.end(), std::greater<>());
+  while (not stl_heap.empty()) {
+    EXPECT_EQ(soft_heap.ExtractMin(), stl_heap.top());
+    stl_heap.pop();
+  }
+}
+
+TEST(RankedTrees, FlatSoftHeapExtractMinVerifyAllElements) {
+  auto rand = detail::generate_rand(3000);
+  auto soft_heap =
+      FlatSoftHeap<int, std::vector<int>, 4, policy::RankedRoots>(rand.begin(),
+                                                                  rand.end());
+  EXPECT_EQ(3000, soft_heap.size());
+  EXPECT_EQ(std::popcount(3000U), soft_heap.trees.size());
+  std::set<int> extracted_elems;
+  for ([[maybe_unused]] auto&& x : rand) {
+    EXPECT_TRUE(extracted_elems.insert(soft_heap.ExtractMin()).second);
+  }
+  EXPECT_EQ(0, soft_heap.size());
+}
+
+// NOLINTEND(modernize-use-trailing-return-type)
+
+}  // namespace soft_heap::test
@@ -0,0 +1,192 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "common.hpp"
+#include "flat_soft_heap.hpp"
+#include "root_min.hpp"
+#include "soft_heap.hpp"
+
+namespace soft_heap::test {
+
+// NOLINTBEGIN(modernize-use-trailing-return-type)
+
+namespace detail {
+
+// Random keys in [0, range), so small ranges give many ties
+template <class Key>
+auto RandomKeys(int range, unsigned seed) {
+  auto keys = std::vector<Key>(64);
+  auto gen = std::mt19937(seed);
+  auto dist = std::uniform_int_distribution<int>(0, range - 1);
+  for (auto& key : keys) {
+    key = static_cast<Key>(dist(gen)) - static_cast<Key>(range / 2);
+  }
+  return keys;
+}
+
+template <class Key>
+void ExpectKernelsMatchScalar() {
+  for (unsigned seed = 0; seed < 200; ++seed) {
+    const auto keys = RandomKeys<Key>(seed % 2 == 0 ? 8 : 1 << 20, seed);
+    const auto expect =
+        soft_heap::detail::ScalarArgMin<Key, policy::NaturalOrder>(
+            keys.data(), 64);
+    for (auto isa : {soft_heap::detail::Isa::kScalar,
+                     soft_heap::detail::Isa::kSse41,
+                     soft_heap::detail::Isa::kAvx2}) {
+      if (isa <= soft_heap::detail::HostIsa()) {
+        EXPECT_EQ(soft_heap::detail::ArgMin(keys.data(), 64, isa), expect);
+      }
+    }
+  }
+}
+
+// With NaNs the minimum may equal no lane; the kernels must still stop at n
+template <class Key>
+void ExpectKernelsStayInBoundsWithNaN() {
+  const auto nan = std::numeric_limits<Key>::quiet_NaN();
+  auto keys = std::vector<Key>(16, nan);
+  for (auto pattern = 0; pattern < 4; ++pattern) {
+    if (pattern != 0) {
+      keys[pattern * 3] = static_cast<Key>(pattern);
+    }
+    for (auto isa : {soft_heap::detail::Isa::kScalar,
+                     soft_heap::detail::Isa::kSse41,
+                     soft_heap::detail::Isa::kAvx2}) {
+      if (isa <= soft_heap::detail::HostIsa()) {
+        const auto min = soft_heap::detail::ArgMin(keys.data(), 8, isa);
+        EXPECT_GE(min, 0);
+        EXPECT_LT(min, 8);
+      }
+    }
+  }
+}
+
+}  // namespace detail
+
+TEST(RootMin, KernelsMatchScalarInt32) {
+  detail::ExpectKernelsMatchScalar<std::int32_t>();
+}
+
+TEST(RootMin, KernelsMatchScalarInt64) {
+  detail::ExpectKernelsMatchScalar<std::int64_t>();
+}
+
+TEST(RootMin, KernelsMatchScalarFloat) {
+  detail::ExpectKernelsMatchScalar<float>();
+}
+
+TEST(RootMin, KernelsMatchScalarDouble) {
+  detail::ExpectKernelsMatchScalar<double>();
+}
+
+TEST(RootMin, KernelsStayInBoundsWithNaN) {
+  detail::ExpectKernelsStayInBoundsWithNaN<float>();
+  detail::ExpectKernelsStayInBoundsWithNaN<double>();
+}
+
+TEST(RootMin, RootKeysSkipEmptyRanks) {
+  auto keys = RootKeys<int, policy::NaturalOrder>();
+  keys.Set(5, 7);
+  keys.Set(9, 3);
+  keys.Set(40, 3);
+  EXPECT_EQ(keys.ArgMin(), 9);
+  keys.Clear(9);
+  EXPECT_EQ(keys.ArgMin(), 40);
+  // a real key equal to the empty-rank filler must still win
+  keys.Set(12, std::numeric_limits<int>::max());
+  keys.Clear(40);
+  EXPECT_EQ(keys.ArgMin(), 5);
+  keys.Clear(5);
+  EXPECT_EQ(keys.ArgMin(), 12);
+}
+
+TEST(RootMin, RootKeysScalarOrder) {
+  auto keys = RootKeys<int, policy::ReverseOrder<>>();
+  static_assert(not decltype(keys)::vectorized);
+  keys.Set(1, 4);
+  keys.Set(2, 9);
+  keys.Set(3, 9);
+  EXPECT_EQ(keys.ArgMin(), 2);
+}
+
+TEST(RootMin, AutoPicksScanForRankedArithmeticKeys) {
+  using ranked = policy::RankedRoots;
+  using linked = policy::LinkedRoots;
+  using natural = policy::NaturalOrder;
+  using Pair = std::pair<int, int>;
+  EXPECT_TRUE((policy::AutoMinRoots::scan<ranked, int, natural>));
+  EXPECT_TRUE((policy::AutoMinRoots::scan<ranked, double, natural>));
+  EXPECT_FALSE((policy::AutoMinRoots::scan<linked, int, natural>));
+  EXPECT_FALSE((policy::AutoMinRoots::scan<ranked, Pair, natural>));
+  EXPECT_FALSE(
+      (policy::AutoMinRoots::scan<ranked, int, policy::ReverseOrder<>>));
+}
+
+template <class Tracking>
+using RankedHeap = SoftHeap<int, std::vector<int>, 4, policy::HeapAllocation,
+                            policy::RankedRoots, policy::NaturalOrder,
+                            Tracking>;
+
+template <class Tracking>
+using RankedFlatHeap =
+    FlatSoftHeap<int, std::vector<int>, 4, policy::RankedRoots,
+                 policy::NaturalOrder, policy::NodeArrayLayout, Tracking>;
+
+TEST(RootMin, SoftHeapScanMatchesSuffixMin) {
+  auto rand = detail::generate_rand(3000);
+  auto mid = std::next(rand.begin(), 1000);
+  auto suffix = RankedHeap<policy::SuffixMinRoots>(rand.begin(), mid);
+  auto scan = RankedHeap<policy::ScanMinRoots>(rand.begin(), mid);
+  for (auto it = mid; it != rand.end(); ++it) {
+    suffix.Insert(*it);
+    scan.Insert(*it);
+    EXPECT_EQ(scan.Top(), suffix.Top());
+    if (*it % 3 == 0) {
+      EXPECT_EQ(scan.ExtractMin(), suffix.ExtractMin());
+    }
+  }
+  while (suffix.size() != 0) {
+    EXPECT_EQ(scan.TopCKey(), suffix.TopCKey());
+    EXPECT_EQ(scan.ExtractMin(), suffix.ExtractMin());
+  }
+  EXPECT_EQ(scan.size(), 0);
+}
+
+TEST(RootMin, FlatSoftHeapScanMatchesSuffixMin) {
+  auto rand = detail::generate_rand(3000);
+  auto mid = std::next(rand.begin(), 1500);
+  auto suffix = RankedFlatHeap<policy::SuffixMinRoots>(rand.begin(), mid);
+  auto scan = RankedFlatHeap<policy::ScanMinRoots>(rand.begin(), mid);
+  suffix.Meld(RankedFlatHeap<policy::SuffixMinRoots>(mid, rand.end()));
+  scan.Meld(RankedFlatHeap<policy::ScanMinRoots>(mid, rand.end()));
+  for ([[maybe_unused]] auto&& x : rand) {
+    EXPECT_EQ(scan.ExtractMin(), suffix.ExtractMin());
+  }
+}
+
+TEST(RootMin, ScanWithCompositeKeys) {
+  auto rand = detail::generate_rand(2000);
+  auto suffix = SoftHeap<std::pair<int, int>, std::vector<std::pair<int, int>>,
+                         4, policy::HeapAllocation, policy::RankedRoots>();
+  auto scan = SoftHeap<std::pair<int, int>, std::vector<std::pair<int, int>>,
+                       4, policy::HeapAllocation, policy::RankedRoots,
+                       policy::NaturalOrder, policy::ScanMinRoots>();
+  for (auto x : rand) {
+    suffix.Insert({x % 7, x});
+    scan.Insert({x % 7, x});
+  }
+  for ([[maybe_unused]] auto&& x : rand) {
+    EXPECT_EQ(scan.ExtractMin(), suffix.ExtractMin());
+  }
+}
+
+// NOLINTEND(modernize-use-trailing-return-type)
+
+}  // namespace soft_heap::test
@@ -0,0 +1,112 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <queue>
+#include <set>
+#include <vector>
+
+#include "common.hpp"
+#include "runtime_epsilon.hpp"
+#include "soft_heap.hpp"
+
+namespace soft_heap::test {
+
+// NOLINTBEGIN(modernize-use-trailing-return-type)
+
+TEST(RuntimeEpsilon, PicksKernelByThreshold) {
+  EXPECT_EQ(RuntimeSoftHeap<int>(1.0 / 2).threshold(), 6);
+  EXPECT_EQ(RuntimeSoftHeap<int>(1.0 / 8).threshold(), 8);
+  EXPECT_EQ(RuntimeSoftHeap<int>(1.0 / 1000).threshold(), 15);
+  // between kernels: round up to the next more accurate one
+  EXPECT_EQ(RuntimeSoftHeap<int>(1.0 / 10).threshold(), 9);
+  EXPECT_EQ(RuntimeSoftHeap<int>(1.0 / 100).threshold(), 15);
+  EXPECT_EQ(RuntimeSoftHeap<int>(1.0).threshold(), 6);
+  EXPECT_GT(RuntimeSoftHeap<int>(1e-6).threshold(), 15);
+  EXPECT_EQ(RuntimeSoftHeap<int>(0.1).epsilon(), 0.1);
+}
+
+TEST(RuntimeEpsilon, NonPositiveOrNaNEpsilonMeansExact) {
+  const auto exact = RuntimeSoftHeap<int>(0.0).threshold();
+  EXPECT_EQ(exact, RuntimeSoftHeap<int>(1e-300).threshold());
+  for (auto epsilon : {-0.5, -std::numeric_limits<double>::infinity(),
+                       std::numeric_limits<double>::quiet_NaN()}) {
+    auto rand = detail::generate_rand(3000);
+    auto soft_heap = RuntimeSoftHeap<int>(epsilon, rand.begin(), rand.end());
+    EXPECT_EQ(soft_heap.threshold(), exact) << epsilon;
+    for (int i = 1; i <= 3000; ++i) {
+      ASSERT_EQ(soft_heap.ExtractMin(), i) << epsilon;
+    }
+  }
+  EXPECT_EQ(RuntimeSoftHeap<int>(2.0).threshold(), 6);
+  EXPECT_EQ(
+      RuntimeSoftHeap<int>(std::numeric_limits<double>::infinity()).threshold(),
+      6);
+}
+
+TEST(RuntimeEpsilon, MatchesStaticKernel) {
+  auto rand = detail::generate_rand(2000);
+  auto runtime = RuntimeSoftHeap<int>(1.0 / 4, rand.begin(), rand.end());
+  auto fixed = SoftHeap<int, std::vector<int>, 4>(rand.begin(), rand.end());
+  EXPECT_EQ(runtime.size(), fixed.size());
+  EXPECT_EQ(runtime.num_corrupted_keys(), fixed.num_corrupted_keys());
+  for ([[maybe_unused]] auto&& x : rand) {
+    EXPECT_EQ(runtime.ExtractMin(), fixed.ExtractMin());
+  }
+  EXPECT_EQ(0, runtime.size());
+}
+
+TEST(RuntimeEpsilon, TopAndTryExtractMinIf) {
+  auto rand = std::vector{3, 1, 2};
+  auto soft_heap = RuntimeSoftHeap<int>(0.001, rand.begin(), rand.end());
+  EXPECT_EQ(1, soft_heap.Top());
+  EXPECT_EQ(1, soft_heap.TopCKey());
+  EXPECT_EQ(soft_heap.TryExtractMinIf([](int x) { return x > 1; }),
+            std::nullopt);
+  EXPECT_EQ(soft_heap.TryExtractMinIf([](int x) { return x == 1; }), 1);
+  EXPECT_EQ(2, soft_heap.Top());
+}
+
+TEST(RuntimeEpsilon, SmallEpsilonIsExact) {
+  auto rand = detail::generate_rand(3000);
+  auto soft_heap = RuntimeSoftHeap<int>(1e-9);
+  for (auto x : rand) {
+    soft_heap.Insert(x);
+  }
+  auto stl_heap =
+      std::priority_queue(rand.begin(), rand.end(), std::greater<>());
+  while (not stl_heap.empty()) {
+    EXPECT_EQ(soft_heap.ExtractMin(), stl_heap.top());
+    stl_heap.pop();
+  }
+}
+
+TEST(RuntimeEpsilon, MeldAcrossKernels) {
+  auto rand = detail::generate_rand(2000);
+  auto mid = std::next(rand.begin(), 700);
+  auto soft_heap = RuntimeSoftHeap<int>(1.0 / 8, rand.begin(), mid);
+  soft_heap.Meld(RuntimeSoftHeap<int>(1.0 / 8, mid, std::next(mid, 300)));
+  soft_heap.Meld(
+      RuntimeSoftHeap<int>(1.0 / 2, std::next(mid, 300), rand.end()));
+  EXPECT_EQ(2000, soft_heap.size());
+  EXPECT_EQ(8, soft_heap.threshold());
+  std::set<int> extracted_elems;
+  for ([[maybe_unused]] auto&& x : rand) {
+    EXPECT_TRUE(extracted_elems.insert(soft_heap.ExtractMin()).second);
+  }
+}
+
+TEST(RuntimeEpsilon, FlatSoftHeapExtractMinVerifyAllElements) {
+  auto rand = detail::generate_rand(3000);
+  auto soft_heap = RuntimeFlatSoftHeap<int>(0.25, rand.begin(), rand.end());
+  EXPECT_EQ(7, soft_heap.threshold());
+  std::set<int> extracted_elems;
+  for ([[maybe_unused]] auto&& x : rand) {
+    EXPECT_TRUE(extracted_elems.insert(soft_heap.ExtractMin()).second);
+  }
+  EXPECT_EQ(0, soft_heap.size());
+}
+
+// NOLINTEND(modernize-use-trailing-return-type)
+
+}  // namespace soft_heap::test
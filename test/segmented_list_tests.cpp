@@ -0,0 +1,123 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <list>
+#include <queue>
+#include <set>
+#include <vector>
+
+#include "common.hpp"
+#include "flat_soft_heap.hpp"
+#include "segmented_list.hpp"
+#include "soft_heap.hpp"
+
+namespace soft_heap::test {
+
+// NOLINTBEGIN(modernize-use-trailing-return-type)
+
+using ::testing::ElementsAre;
+using List = SegmentedList<int, 4>;
+
+TEST(SegmentedList, PushAndPopBack) {
+  auto list = List{1, 2, 3, 4, 5, 6};
+  EXPECT_EQ(list.size(), 6);
+  EXPECT_EQ(list.back(), 6);
+  EXPECT_THAT(list, ElementsAre(1, 2, 3, 4, 5, 6));
+  for (int i = 6; i > 0; --i) {
+    EXPECT_EQ(list.back(), i);
+    list.pop_back();
+  }
+  EXPECT_TRUE(list.empty());
+  EXPECT_EQ(list.begin(), list.end());
+  list.push_back(7);
+  EXPECT_THAT(list, ElementsAre(7));
+}
+
+TEST(SegmentedList, SpliceRelinksSegments) {
+  auto list = List{1, 2, 3};
+  auto that = List{4, 5, 6, 7, 8};
+  list.splice(list.end(), that);
+  EXPECT_TRUE(that.empty());
+  EXPECT_EQ(list.size(), 8);
+  EXPECT_EQ(list.back(), 8);
+  EXPECT_THAT(list, ElementsAre(1, 2, 3, 4, 5, 6, 7, 8));
+  while (list.size() > 2) {
+    list.pop_back();
+  }
+  EXPECT_THAT(list, ElementsAre(1, 2));
+}
+
+TEST(SegmentedList, SpliceFoldsShortSegment) {
+  auto list = List{1, 2};
+  auto that = List{3};
+  list.splice(list.end(), that);
+  EXPECT_THAT(list, ElementsAre(1, 2, 3));
+  auto empty = List{};
+  empty.splice(empty.end(), list);
+  EXPECT_THAT(empty, ElementsAre(1, 2, 3));
+  empty.splice(empty.end(), list);  // splicing an empty list is a no-op
+  EXPECT_EQ(empty.size(), 3);
+}
+
+TEST(SegmentedList, CopyAndCompare) {
+  const auto list = List{1, 2, 3, 4, 5};
+  auto copy = list;
+  EXPECT_EQ(copy, list);
+  copy.pop_back();
+  EXPECT_LT(copy, list);
+  copy.push_back(6);
+  EXPECT_GT(copy, list);
+}
+
+TEST(SegmentedList, NodeSift) {
+  using N = Node<int, List, 8>;
+  auto node = std::make_unique<N>(10, 4, List{1});
+  node->left = std::make_unique<N>(9, 1, List{2, 3});
+  node->right = std::make_unique<N>(9, 1, List{5});
+  node->Sift();
+  EXPECT_NODE_EQ(node, N{10, 4, List{1, 2, 3, 5}});
+  EXPECT_TRUE(node->IsLeaf());
+}
+
+TEST(SegmentedList, SoftHeapExtractMin) {
+  auto rand = detail::generate_rand(3000);
+  auto soft_heap =
+      SoftHeap<int, SegmentedList<int>, 1000>(rand.begin(), rand.end());
+  auto stl_heap =
+      std::priority_queue(rand.begin(), rand.end(), std::greater<>());
+  while (not stl_heap.empty()) {
+    EXPECT_EQ(soft_heap.ExtractMin(), stl_heap.top());
+    stl_heap.pop();
+  }
+}
+
+TEST(SegmentedList, SoftHeapMatchesVector) {
+  auto rand = detail::generate_rand(3000);
+  auto vector_heap =
+      SoftHeap<int, std::vector<int>, 4>(rand.begin(), rand.end());
+  auto list_heap = SoftHeap<int, std::list<int>, 4>(rand.begin(), rand.end());
+  auto segmented_heap =
+      SoftHeap<int, SegmentedList<int>, 4>(rand.begin(), rand.end());
+  EXPECT_EQ(vector_heap.num_corrupted_keys(),
+            segmented_heap.num_corrupted_keys());
+  for ([[maybe_unused]] auto&& x : rand) {
+    const auto elem = segmented_heap.ExtractMin();
+    EXPECT_EQ(elem, list_heap.ExtractMin());
+    EXPECT_EQ(elem, vector_heap.ExtractMin());
+  }
+}
+
+TEST(SegmentedList, FlatSoftHeapExtractMinVerifyAllElements) {
+  auto rand = detail::generate_rand(3000);
+  auto soft_heap =
+      FlatSoftHeap<int, SegmentedList<int>, 4>(rand.begin(), rand.end());
+  std::set<int> extracted_elems;
+  for ([[maybe_unused]] auto&& x : rand) {
+    EXPECT_TRUE(extracted_elems.insert(soft_heap.ExtractMin()).second);
+  }
+  EXPECT_EQ(0, soft_heap.size());
+}
+
+// NOLINTEND(modernize-use-trailing-return-type)
+
+}  // namespace soft_heap::test
@@ -1,13 +1,16 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <fstream>
 #include <functional>
 #include <queue>
 #include <random>
+#include <span>
 #include <vector>
 
 #include "common.hpp"
+#include "flat_soft_heap.hpp"
 #include "soft_heap.hpp"
 
 namespace soft_heap::test {
@@ -26,6 +29,190 @@ TEST(SoftHeap, STLConstruct) {
   fout << soft_heap;
 }
 
+TEST(SoftHeap, InsertKeepsSuffixMin) {
+  // the last insert starts a new rank 0 tree in front of a smaller root
+  auto soft_heap = SoftHeap<int, std::vector<int>, 1000>(1);
+  soft_heap.Insert(2);
+  soft_heap.Insert(5);
+  EXPECT_EQ(1, soft_heap.ExtractMin());
+  EXPECT_EQ(2, soft_heap.ExtractMin());
+  EXPECT_EQ(5, soft_heap.ExtractMin());
+}
+
+TEST(SoftHeap, BulkConstructMatchesInsert) {
+  auto rand = detail::generate_rand(2000);
+  auto bulk = SoftHeap<int, std::vector<int>, 4>(rand.begin(), rand.end());
+  auto inserted = SoftHeap<int, std::vector<int>, 4>(std::move(rand[0]));
+  for (int i = 1; i < 2000; ++i) {
+    inserted.Insert(std::move(rand[i]));
+  }
+  ASSERT_EQ(bulk.trees.size(), inserted.trees.size());
+  EXPECT_EQ(bulk.rank(), inserted.rank());
+  EXPECT_EQ(bulk.size(), inserted.size());
+  EXPECT_EQ(bulk.num_corrupted_keys(), inserted.num_corrupted_keys());
+  for ([[maybe_unused]] auto&& x : rand) {
+    EXPECT_EQ(bulk.ExtractMin(), inserted.ExtractMin());
+  }
+}
+
+TEST(SoftHeap, BulkConstructEmptyRange) {
+  auto empty = std::vector<int>();
+  auto soft_heap = SoftHeap<int>(empty.begin(), empty.end());
+  EXPECT_EQ(0, soft_heap.size());
+  EXPECT_TRUE(soft_heap.trees.empty());
+  soft_heap.Insert(3);
+  EXPECT_EQ(3, soft_heap.ExtractMin());
+}
+
+namespace detail {
+
+// A key that records being moved from, ordered by its value alone
+struct MoveTracked {
+  MoveTracked() = default;
+  explicit MoveTracked(int value) : value(value) {}
+  MoveTracked(const MoveTracked&) = default;
+  MoveTracked(MoveTracked&& that) noexcept : value(that.value) {
+    that.moved_from = true;
+  }
+  auto operator=(const MoveTracked&) -> MoveTracked& = default;
+  auto operator=(MoveTracked&& that) noexcept -> MoveTracked& {
+    value = that.value;
+    that.moved_from = true;
+    return *this;
+  }
+  friend auto operator==(const MoveTracked& x, const MoveTracked& y) {
+    return x.value == y.value;
+  }
+  friend auto operator<=>(const MoveTracked& x, const MoveTracked& y) {
+    return x.value <=> y.value;
+  }
+
+  int value = 0;
+  bool moved_from = false;
+};
+
+template <class Heap>
+void ExpectBulkBuildCopiesKeys() {
+  auto keys = std::vector<MoveTracked>();
+  for (auto x : generate_rand(100)) {
+    keys.emplace_back(x);
+  }
+  const auto source = keys;
+  auto copied = Heap(keys.begin(), keys.end());
+  EXPECT_EQ(keys, source);
+  EXPECT_TRUE(std::none_of(keys.begin(), keys.end(),
+                           [](auto& key) { return key.moved_from; }));
+  copied.InsertRange(keys.begin(), keys.end());
+  EXPECT_TRUE(std::none_of(keys.begin(), keys.end(),
+                           [](auto& key) { return key.moved_from; }));
+  auto moved = Heap(std::make_move_iterator(keys.begin()),
+                    std::make_move_iterator(keys.end()));
+  EXPECT_TRUE(std::all_of(keys.begin(), keys.end(),
+                          [](auto& key) { return key.moved_from; }));
+  EXPECT_EQ(copied.size(), 200);
+  EXPECT_EQ(moved.size(), 100);
+}
+
+}  // namespace detail
+
+TEST(SoftHeap, BulkConstructLeavesTheSourceRangeUnchanged) {
+  detail::ExpectBulkBuildCopiesKeys<
+      SoftHeap<detail::MoveTracked, std::vector<detail::MoveTracked>>>();
+  detail::ExpectBulkBuildCopiesKeys<
+      FlatSoftHeap<detail::MoveTracked, std::vector<detail::MoveTracked>>>();
+}
+
+TEST(SoftHeap, TopPeeksNextExtractMin) {
+  auto rand = detail::generate_rand(2000);
+  auto soft_heap = SoftHeap<int, std::vector<int>, 4>(rand.begin(), rand.end());
+  for ([[maybe_unused]] auto&& x : rand) {
+    const auto top = soft_heap.Top();
+    EXPECT_LE(top, soft_heap.TopCKey());
+    EXPECT_EQ(top, soft_heap.ExtractMin());
+  }
+}
+
+TEST(SoftHeap, TryExtractMinIf) {
+  auto rand = std::vector{4, 2, 6, 1, 5, 3};
+  auto soft_heap =
+      SoftHeap<int, std::vector<int>, 1000>(rand.begin(), rand.end());
+  const auto below = [](int bound) { return [=](int x) { return x < bound; }; };
+  EXPECT_EQ(soft_heap.TryExtractMinIf(below(1)), std::nullopt);
+  EXPECT_EQ(6, soft_heap.size());
+  EXPECT_EQ(soft_heap.TryExtractMinIf(below(3)), 1);
+  EXPECT_EQ(soft_heap.TryExtractMinIf(below(3)), 2);
+  EXPECT_EQ(soft_heap.TryExtractMinIf(below(3)), std::nullopt);
+  EXPECT_EQ(3, soft_heap.Top());
+  while (soft_heap.TryExtractMinIf(below(7))) {
+  }
+  EXPECT_EQ(0, soft_heap.size());
+  EXPECT_EQ(soft_heap.TryExtractMinIf(below(7)), std::nullopt);
+}
+
+TEST(SoftHeap, ExtractMinBatch) {
+  auto rand = detail::generate_rand(3000);
+  auto soft_heap =
+      SoftHeap<int, std::vector<int>, 1000>(rand.begin(), rand.end());
+  auto extracted = std::vector<int>();
+  for (int i = 0; i < 10; ++i) {
+    soft_heap.ExtractMinBatch(std::back_inserter(extracted), 137);
+  }
+  EXPECT_EQ(1630, soft_heap.size());
+  auto out = std::vector<int>(2000);
+  EXPECT_EQ(1630, soft_heap.ExtractMinBatch(std::span(out)));
+  EXPECT_EQ(0, soft_heap.size());
+  EXPECT_TRUE(soft_heap.trees.empty());
+  extracted.insert(extracted.end(), out.begin(), std::next(out.begin(), 1630));
+  std::sort(rand.begin(), rand.end());
+  EXPECT_EQ(extracted, rand);
+}
+
+TEST(SoftHeap, ExtractMinBatchWithCorruption) {
+  auto rand = detail::generate_rand(3000);
+  auto soft_heap = SoftHeap<int, std::vector<int>, 2>(rand.begin(), rand.end());
+  auto extracted = std::vector<int>();
+  for (int i = 0; i < 1000; ++i) {
+    extracted.push_back(soft_heap.ExtractMin());
+  }
+  soft_heap.ExtractMinBatch(std::back_inserter(extracted), 1500);
+  EXPECT_EQ(500, soft_heap.size());
+  soft_heap.ExtractMinBatch(std::back_inserter(extracted), 500);
+  std::sort(rand.begin(), rand.end());
+  std::sort(extracted.begin(), extracted.end());
+  EXPECT_EQ(extracted, rand);
+}
+
+TEST(SoftHeap, MeldCarriesThroughEqualRanks) {
+  // ranks {0, 1} into {0, 1, 2}: the rank 1 carry meets two rank 1 trees
+  for (const auto& [a, b] : {std::pair{3, 7}, {7, 3}, {5, 23}, {31, 33}}) {
+    auto rand = detail::generate_rand(a + b);
+    auto soft_heap = SoftHeap<int, std::vector<int>, 1000>(
+        rand.begin(), std::next(rand.begin(), a));
+    soft_heap.Meld(SoftHeap<int, std::vector<int>, 1000>(
+        std::next(rand.begin(), a), rand.end()));
+    for (int i = 1; i <= a + b; ++i) {
+      EXPECT_EQ(i, soft_heap.ExtractMin());
+    }
+  }
+}
+
+TEST(SoftHeap, InsertRange) {
+  auto rand = detail::generate_rand(3000);
+  auto soft_heap = SoftHeap<int, std::vector<int>, 1000>();
+  for (int i = 0; i < 3000; i += 250) {
+    soft_heap.InsertRange(std::next(rand.begin(), i),
+                          std::next(rand.begin(), i + 250));
+  }
+  soft_heap.InsertRange(rand.end(), rand.end());
+  EXPECT_EQ(3000, soft_heap.size());
+  auto stl_heap =
+      std::priority_queue(rand.begin(), rand.end(), std::greater<>());
+  while (not stl_heap.empty()) {
+    EXPECT_EQ(soft_heap.ExtractMin(), stl_heap.top());
+    stl_heap.pop();
+  }
+}
+
 TEST(SoftHeap, Extract) {
   // auto rand = std::vector{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
   auto rand = detail::generate_rand(50);
@@ -0,0 +1,102 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bit>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "common.hpp"
+#include "flat_soft_heap.hpp"
+#include "soft_heap.hpp"
+#include "stats.hpp"
+
+namespace soft_heap::test {
+
+// NOLINTBEGIN(modernize-use-trailing-return-type)
+
+using Counted =
+    SoftHeap<int, std::vector<int>, 8, policy::HeapAllocation,
+             policy::LinkedRoots, policy::NaturalOrder, policy::AutoMinRoots,
+             policy::CountingStats>;
+using FlatCounted =
+    FlatSoftHeap<int, std::vector<int>, 8, policy::LinkedRoots,
+                 policy::NaturalOrder, policy::NodeArrayLayout,
+                 policy::AutoMinRoots, policy::CountingStats>;
+
+TEST(Stats, NoStatsTakesNoSpace) {
+  EXPECT_TRUE(std::is_empty_v<policy::NoStats>);
+  auto heap = SoftHeap<int>();
+  heap.Insert(1);
+  EXPECT_EQ(heap.stats(), StatsSnapshot());
+}
+
+TEST(Stats, InsertsCombineLikeABinaryCounter) {
+  auto heap = Counted();
+  for (int n = 1; n <= 100; ++n) {
+    heap.Insert(n);
+    const auto stats = heap.stats();
+    EXPECT_EQ(stats.inserts, n);
+    EXPECT_EQ(stats.combines, n - std::popcount(static_cast<unsigned>(n)));
+  }
+}
+
+TEST(Stats, ExtractsSiftAndDeleteLeaves) {
+  auto rand = detail::generate_rand(2000);
+  auto heap = Counted(rand.begin(), rand.end());
+  const auto built = heap.stats();
+  EXPECT_EQ(built.inserts, rand.size());
+  EXPECT_EQ(built.extracts, 0);
+  for ([[maybe_unused]] auto&& x : rand) {
+    (void)heap.ExtractMin();
+  }
+  const auto drained = heap.stats();
+  EXPECT_EQ(drained.extracts, rand.size());
+  EXPECT_GT(drained.sifts, built.sifts);
+  EXPECT_GT(drained.leaf_deletions, built.leaf_deletions);
+  EXPECT_GE(drained.elements_moved, drained.sifts);
+  EXPECT_GT(drained.suffix_min_updates, built.suffix_min_updates);
+}
+
+TEST(Stats, MeldSumsBothHistories) {
+  auto rand = detail::generate_rand(1000);
+  const auto mid = std::next(rand.begin(), 300);
+  auto heap = Counted(rand.begin(), mid);
+  auto that = Counted(mid, rand.end());
+  auto expect = heap.stats();
+  expect += that.stats();
+  heap.Meld(std::move(that));
+  const auto stats = heap.stats();
+  EXPECT_EQ(stats.inserts, rand.size());
+  EXPECT_EQ(stats.melds, 1);
+  EXPECT_GT(stats.combines, expect.combines);
+}
+
+// Up to the first compaction, which relinks a sparse flat tree where the
+// pointer tree simply keeps its freed nodes out
+TEST(Stats, FlatTreeSiftsLikeNodes) {
+  auto rand = detail::generate_rand(3000);
+  auto heap = Counted(rand.begin(), rand.end());
+  auto flat = FlatCounted(rand.begin(), rand.end());
+  auto stats = heap.stats();
+  auto flat_stats = flat.stats();
+  while (flat.stats().compactions == 0) {
+    ASSERT_NE(flat.size(), 0);
+    stats = heap.stats();
+    flat_stats = flat.stats();
+    EXPECT_EQ(heap.ExtractMin(), flat.ExtractMin());
+  }
+  EXPECT_EQ(heap.stats().compactions, 0);
+  EXPECT_EQ(flat.stats().compactions, 1);
+  EXPECT_GT(flat_stats.extracts, rand.size() / 4);
+  EXPECT_EQ(flat_stats.combines, stats.combines);
+  EXPECT_EQ(flat_stats.sifts, stats.sifts);
+  EXPECT_EQ(flat_stats.elements_moved, stats.elements_moved);
+  EXPECT_EQ(flat_stats.leaf_deletions, stats.leaf_deletions);
+  EXPECT_EQ(flat_stats.extracts, stats.extracts);
+}
+
+// NOLINTEND(modernize-use-trailing-return-type)
+
+}  // namespace soft_heap::test
@@ -0,0 +1,175 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "common.hpp"
+#include "workload.hpp"
+
+namespace soft_heap::test {
+
+// NOLINTBEGIN(modernize-use-trailing-return-type)
+
+namespace detail {
+
+[[nodiscard]] inline auto IsPermutation(std::vector<int> v) {
+  std::sort(v.begin(), v.end());
+  auto iota = std::vector<int>(v.size());
+  std::iota(iota.begin(), iota.end(), 1);
+  return v == iota;
+}
+
+// A fresh directory under the system temporary one, removed on destruction
+class ScratchDirectory {
+ public:
+  explicit ScratchDirectory(const std::string& name)
+      : path(std::filesystem::temp_directory_path() / name) {
+    std::filesystem::remove_all(path);
+  }
+  ScratchDirectory(const ScratchDirectory&) = delete;
+  auto operator=(const ScratchDirectory&) -> ScratchDirectory& = delete;
+  ~ScratchDirectory() {
+    auto error = std::error_code();
+    std::filesystem::remove_all(path, error);
+  }
+
+  std::filesystem::path path;
+};
+
+}  // namespace detail
+
+using workload::Distribution;
+
+TEST(Workload, SameSeedSameKeys) {
+  for (auto distribution : workload::distributions) {
+    EXPECT_EQ(workload::Generate(distribution, 5000, 42),
+              workload::Generate(distribution, 5000, 42))
+        << workload::Name(distribution);
+  }
+  EXPECT_NE(workload::Generate(Distribution::kUniform, 5000, 1),
+            workload::Generate(Distribution::kUniform, 5000, 2));
+  EXPECT_EQ(detail::generate_rand(5000),
+            workload::Generate(Distribution::kUniform, 5000));
+}
+
+TEST(Workload, SizesAndEmptyInputs) {
+  for (auto distribution : workload::distributions) {
+    for (std::size_t n : {0, 1, 2, 3, 1000, 1025}) {
+      EXPECT_EQ(workload::Generate(distribution, n).size(), n)
+          << workload::Name(distribution) << ' ' << n;
+    }
+  }
+}
+
+TEST(Workload, DistinctDistributionsArePermutations) {
+  for (auto distribution :
+       {Distribution::kUniform, Distribution::kSorted, Distribution::kReverse,
+        Distribution::kNearlySorted, Distribution::kAdversarial}) {
+    for (std::size_t n : {1, 2, 1000, 1025}) {
+      EXPECT_TRUE(detail::IsPermutation(workload::Generate(distribution, n)))
+          << workload::Name(distribution) << ' ' << n;
+    }
+  }
+}
+
+TEST(Workload, Shapes) {
+  const auto n = std::size_t{10'000};
+  const auto sorted = workload::Generate(Distribution::kSorted, n);
+  EXPECT_TRUE(std::is_sorted(sorted.begin(), sorted.end()));
+  const auto reverse = workload::Generate(Distribution::kReverse, n);
+  EXPECT_TRUE(std::is_sorted(reverse.rbegin(), reverse.rend()));
+
+  const auto nearly = workload::Generate(Distribution::kNearlySorted, n);
+  EXPECT_FALSE(std::is_sorted(nearly.begin(), nearly.end()));
+  for (std::size_t i = 0; i < n; ++i) {
+    EXPECT_LE(std::abs(nearly[i] - static_cast<int>(i + 1)), 16 * 4);
+  }
+
+  const auto duplicates = workload::Generate(Distribution::kDuplicates, n);
+  EXPECT_EQ(std::set(duplicates.begin(), duplicates.end()).size(), 16);
+
+  // about half of Zipf(1) keys fall at or below sqrt(n)
+  const auto zipf = workload::Generate(Distribution::kZipf, n);
+  EXPECT_TRUE(std::all_of(zipf.begin(), zipf.end(), [&](int x) {
+    return x >= 1 and x <= static_cast<int>(n);
+  }));
+  const auto low = std::count_if(zipf.begin(), zipf.end(),
+                                 [](int x) { return x <= 100; });
+  EXPECT_NEAR(static_cast<double>(low) / n, 0.5, 0.05);
+
+  // 100 ascending runs of 100 distinct keys
+  const auto saw = workload::Generate(Distribution::kSawtooth, n);
+  EXPECT_EQ(std::set(saw.begin(), saw.end()).size(), n);
+  auto descents = 0;
+  for (std::size_t i = 1; i < n; ++i) {
+    descents += saw[i] < saw[i - 1];
+  }
+  EXPECT_EQ(descents, 99);
+
+  const auto adversarial = workload::Generate(Distribution::kAdversarial, 8);
+  EXPECT_THAT(adversarial, ::testing::ElementsAre(1, 5, 3, 7, 2, 6, 4, 8));
+}
+
+TEST(Workload, RandIntIsSeededAndInRange) {
+  auto gen = std::mt19937_64(workload::default_seed);
+  auto again = std::mt19937_64(workload::default_seed);
+  for (auto i = 0; i < 1000; ++i) {
+    const auto x = workload::rand_int(-3, 3, gen);
+    EXPECT_EQ(workload::rand_int(-3, 3, again), x);
+    EXPECT_GE(x, -3);
+    EXPECT_LE(x, 3);
+  }
+  const auto widest = std::numeric_limits<int>::max();
+  EXPECT_LE(workload::rand_int(0, widest, gen), widest);
+  EXPECT_EQ(workload::rand_int(7, 7), 7);
+}
+
+TEST(Workload, CachedRoundTrip) {
+  const auto scratch = detail::ScratchDirectory("soft_heap_workload_test");
+  const auto expect = workload::Generate(Distribution::kZipf, 3000, 7);
+  EXPECT_EQ(workload::Cached(Distribution::kZipf, 3000, 7, scratch.path),
+            expect);
+  ASSERT_EQ(std::distance(std::filesystem::directory_iterator(scratch.path),
+                          std::filesystem::directory_iterator()),
+            1);
+  EXPECT_EQ(workload::Cached(Distribution::kZipf, 3000, 7, scratch.path),
+            expect);
+  EXPECT_EQ(workload::Cached(Distribution::kZipf, 3000, 8, scratch.path),
+            workload::Generate(Distribution::kZipf, 3000, 8));
+}
+
+TEST(Workload, CachedRegeneratesATruncatedFile) {
+  const auto scratch = detail::ScratchDirectory("soft_heap_workload_test");
+  const auto expect = workload::Generate(Distribution::kUniform, 3000);
+  ASSERT_EQ(workload::Cached(Distribution::kUniform, 3000,
+                             workload::default_seed, scratch.path),
+            expect);
+  const auto file =
+      std::filesystem::directory_iterator(scratch.path)->path();
+  std::filesystem::resize_file(file, 100);
+  EXPECT_EQ(workload::Cached(Distribution::kUniform, 3000,
+                             workload::default_seed, scratch.path),
+            expect);
+  EXPECT_EQ(std::filesystem::file_size(file), 3000 * sizeof(int));
+}
+
+TEST(Workload, CachedWithoutAWritableDirectory) {
+  const auto scratch = detail::ScratchDirectory("soft_heap_workload_test");
+  std::ofstream(scratch.path) << "not a directory";
+  EXPECT_EQ(workload::Cached(Distribution::kSawtooth, 500,
+                             workload::default_seed, scratch.path / "cache"),
+            workload::Generate(Distribution::kSawtooth, 500));
+}
+
+// NOLINTEND(modernize-use-trailing-return-type)
+
+}  // namespace soft_heap::test